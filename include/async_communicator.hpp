@@ -0,0 +1,146 @@
+#pragma once
+
+#include "message.hpp"
+#include "observer.hpp"
+#include "ethernet.hpp"
+#include "executor.hpp"
+#include "read_mostly.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+using Mac_Address = Ethernet::Mac_Address;
+using Thread_ID = Ethernet::Thread_ID;
+
+// Comunicador sem thread própria: em vez de bloquear em receive, o componente
+// registra handlers por tipo, por origem ou para qualquer mensagem, e cada
+// mensagem recebida é tratada no executor compartilhado. Assim milhares de
+// componentes leves rodam sobre as poucas threads do executor.
+// As mensagens aceitas esperam numa fila limitada do comunicador, com a mesma
+// configuração (capacidade, política de estouro e conflação) da fila de um
+// Communicator; o executor recebe no máximo uma tarefa por mensagem na fila.
+// Um handler serializado roda uma mensagem por vez, na ordem de chegada; um não
+// serializado pode rodar em várias threads ao mesmo tempo.
+// Handlers não devem bloquear: cada um ocupa uma thread do executor.
+class AsyncCommunicator {
+public:
+    typedef std::function<void(const MessageRef&)> Handler;
+
+    // Contadores do comunicador
+    struct Statistics {
+        uint64_t messages_dispatched = 0;    // Mensagens entregues a um handler
+        uint64_t messages_unhandled = 0;     // Mensagens descartadas por não haver handler
+        uint64_t messages_dropped = 0;       // Mensagens novas recusadas com a fila cheia (DROP_NEWEST, BLOCK numa thread do executor ou após o destrutor começar)
+        uint64_t messages_overwritten = 0;   // Mensagens antigas descartadas com a fila cheia (DROP_OLDEST)
+        uint64_t messages_conflated = 0;     // Mensagens pendentes substituídas por uma mais recente
+        uint64_t producer_waits = 0;         // Vezes que um produtor esperou espaço (BLOCK)
+        size_t high_water = 0;               // Maior ocupação da fila
+        size_t capacity = 0;
+    };
+
+    // Construtor: o identificador do componente é gerado (não há thread para identificá-lo)
+    AsyncCommunicator(Protocol* protocol, Mac_Address vehicle_id, Executor* executor);
+
+    // Construtor com a capacidade e a política de estouro da fila
+    AsyncCommunicator(Protocol* protocol, Mac_Address vehicle_id, Executor* executor,
+                      const Concurrent_Observer::Config& queue_config);
+
+    // Construtor com o identificador do componente
+    AsyncCommunicator(Protocol* protocol, Mac_Address vehicle_id, Thread_ID component_id, Executor* executor,
+                      const Concurrent_Observer::Config& queue_config = Concurrent_Observer::Config());
+
+    // Destrutor: desanexa do protocolo e espera os handlers em execução e as mensagens na fila.
+    // Não pode ser chamado por um handler do próprio comunicador. Um comunicador inscrito no
+    // DataPublisher deve ser desinscrito antes (unsubscribe(getObserver())).
+    ~AsyncCommunicator();
+
+    AsyncCommunicator(const AsyncCommunicator&) = delete;
+    AsyncCommunicator& operator=(const AsyncCommunicator&) = delete;
+
+    // Registra (ou substitui) o handler das mensagens de um tipo
+    void on(Ethernet::Type type, Handler handler, bool serialized = true);
+
+    // Registra (ou substitui) o handler das mensagens de uma origem; tem precedência sobre o tipo
+    void on_source(Ethernet::Address source, Handler handler, bool serialized = true);
+
+    // Registra (ou substitui) o handler das mensagens sem handler de origem ou de tipo
+    void on_any(Handler handler, bool serialized = true);
+
+    // Envia uma mensagem (pode ser chamado pelos handlers)
+    bool send(Message* message);
+
+    // Envia 'count' mensagens em um único lote de transmissão da NIC
+    size_t send_many(Message* messages, size_t count);
+
+    // Endereço (MAC e identificador) do comunicador, usado como origem das mensagens enviadas
+    Ethernet::Address address() const;
+
+    // Observador a inscrever no DataPublisher para receber interesses
+    Concurrent_Observer* getObserver();
+
+    Statistics statistics() const;
+
+private:
+    // Handler registrado
+    struct Binding {
+        Handler handler;
+        bool serialized;
+        bool running = false;   // Um handler serializado está rodando (protegido por queue_mutex)
+    };
+
+    // Mensagem aceita e ainda não entregue ao handler
+    struct Job {
+        MessageRef message;
+        std::shared_ptr<Binding> binding;
+    };
+
+    struct AddressHash {
+        size_t operator()(const Ethernet::Address& address) const;
+    };
+
+    // Handlers lidos sem locks a cada mensagem e alterados raramente
+    struct Handlers {
+        std::unordered_map<Ethernet::Type, std::shared_ptr<Binding>> by_type;
+        std::unordered_map<Ethernet::Address, std::shared_ptr<Binding>, AddressHash> by_source;
+        std::shared_ptr<Binding> any;
+    };
+
+    // Observador anexado ao protocolo: escolhe o handler na thread do produtor e enfileira
+    class Dispatcher : public Concurrent_Observer {
+    public:
+        explicit Dispatcher(AsyncCommunicator* owner) : owner(owner) {}
+        void update(const MessageRef& message) override;
+
+    private:
+        AsyncCommunicator* owner;
+    };
+
+    std::shared_ptr<Binding> bind(Handler handler, bool serialized);
+    void dispatch(const MessageRef& message);
+    bool conflates(const MessageRef& message) const;
+    void pump();
+
+    Protocol* _protocol;
+    Executor* _executor;
+    Ethernet::Address _address;
+    Concurrent_Observer::Config _config;
+    Dispatcher dispatcher;
+    ReadMostly<Handlers> handlers;
+
+    std::atomic<uint64_t> unhandled{0};
+
+    // Fila limitada de mensagens aceitas, em ordem de chegada, e contadores
+    std::deque<Job> queue;
+    size_t pumps = 0;             // Tarefas de entrega postadas no executor e ainda não terminadas
+    bool closing = false;         // O destrutor começou: nenhuma mensagem nova é aceita
+    Statistics stats;
+    mutable std::mutex queue_mutex;
+    std::condition_variable space;     // Uma posição da fila foi liberada (BLOCK) ou o destrutor começou
+    std::condition_variable drained;   // A última tarefa de entrega terminou
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Pool de blocos de tamanho fixo usado pela NIC para os seus Buffers.
+// Todos os blocos são reservados de uma vez (com mmap, opcionalmente em
+// hugepages) e os livres ficam em uma pilha sem lock (Treiber) indexada, cujo
+// topo carrega um contador de versão contra o problema ABA. acquire() e
+// release() podem ser chamados por qualquer thread e nunca alocam memória.
+// Quando o pool se esgota, acquire() retorna nullptr e conta o evento.
+class BufferPool {
+public:
+    // Configuração do pool
+    struct Config {
+        unsigned int capacity = 1024;   // Número de blocos
+        unsigned int reserve = 0;       // Blocos livres abaixo dos quais o pool está baixo (0 = capacity / 4)
+        bool huge_pages = false;        // Tenta usar hugepages (MAP_HUGETLB), senão usa páginas normais
+    };
+
+    // Contadores do pool
+    struct Statistics {
+        uint64_t capacity = 0;          // Número de blocos
+        uint64_t in_use = 0;            // Blocos entregues e ainda não devolvidos
+        uint64_t high_water = 0;        // Maior valor já atingido por in_use
+        uint64_t acquired = 0;          // Total de blocos entregues
+        uint64_t exhausted = 0;         // Pedidos recusados por falta de blocos
+        bool huge_pages = false;        // Se a memória do pool está em hugepages
+    };
+
+    BufferPool(size_t block_size, const Config& config);
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // Retira um bloco do pool (nullptr se esgotado)
+    void* acquire();
+
+    // Devolve ao pool um bloco obtido com acquire()
+    void release(void* block);
+
+    // Verifica se o endereço pertence a um bloco do pool
+    bool contains(const void* block) const;
+
+    // Verifica se restam apenas os blocos da reserva: quem for guardar um bloco por
+    // tempo indeterminado deve copiar os dados, deixando a reserva para os envios.
+    bool low() const {
+        return capacity - in_use.load(std::memory_order_relaxed) <= reserve;
+    }
+
+    Statistics statistics() const;
+
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;  // Índice que marca a pilha vazia
+
+    size_t block_size;
+    uint32_t capacity;
+    uint32_t reserve;
+    uint8_t* memory = nullptr;
+    size_t memory_size = 0;
+    bool huge_pages = false;
+
+    // Próximo bloco livre de cada bloco livre
+    std::atomic<uint32_t>* next = nullptr;
+    // Topo da pilha de livres: versão nos 32 bits altos, índice nos 32 baixos
+    std::atomic<uint64_t> head;
+
+    std::atomic<uint64_t> in_use{0};
+    std::atomic<uint64_t> high_water{0};
+    std::atomic<uint64_t> acquired{0};
+    std::atomic<uint64_t> exhausted{0};
+};
@@ -5,6 +5,7 @@
 #include "ethernet.hpp"
 
 #include <array>
+#include <chrono>
 
 using Mac_Address = Ethernet::Mac_Address;
 using Thread_ID = Ethernet::Thread_ID;
@@ -14,20 +15,46 @@ public:
     // Construtor: inicializa o comunicador com o protocolo, endereço MAC e porta
     Communicator(Protocol* protocol, Mac_Address vehicle_id, Thread_ID component_id);
 
+    // Construtor com a capacidade e a política de estouro da fila de recepção
+    Communicator(Protocol* protocol, Mac_Address vehicle_id, Thread_ID component_id,
+                 const Concurrent_Observer::Config& queue_config);
+
     // Destrutor: desanexa o observador do protocolo
     ~Communicator();
 
     // Envia uma mensagem
     bool send(Message* message);
 
-    // Recebe uma mensagem
+    // Recebe uma mensagem (copia cabeçalho e dados para 'message')
     bool receive(Message* message);
 
+    // Recebe uma mensagem sem copiar os dados: 'message' passa a referenciar
+    // a mensagem recebida, cujos dados podem ser lidos enquanto a referência existir
+    bool receive(MessageRef* message);
+
+    // Como receive, mas espera no máximo 'timeout' / até 'deadline'; retorna false se
+    // nenhuma mensagem chegou (a thread dorme no semáforo, sem consultar a fila)
+    bool receive_for(Message* message, std::chrono::steady_clock::duration timeout);
+    bool receive_for(MessageRef* message, std::chrono::steady_clock::duration timeout);
+    bool receive_until(Message* message, std::chrono::steady_clock::time_point deadline);
+    bool receive_until(MessageRef* message, std::chrono::steady_clock::time_point deadline);
+
+    // Recebe em lote: espera a primeira mensagem por até 'timeout' e retira, com um único
+    // lock da fila, até 'max' mensagens já recebidas. Retorna quantas foram recebidas.
+    size_t receive_many(Message* messages, size_t max, std::chrono::steady_clock::duration timeout);
+    size_t receive_many(MessageRef* messages, size_t max, std::chrono::steady_clock::duration timeout);
+
+    // Envia 'count' mensagens em um único lote de transmissão da NIC (um sendmmsg,
+    // um kick do XDP, um io_uring_enter). Retorna quantas foram enviadas.
+    size_t send_many(Message* messages, size_t count);
+
     // Retorna se há mensagens disponíveis
     bool hasMessage();
 
     Concurrent_Observer* getObserver();
-    
+
+    // Ocupação máxima e descartes da fila de recepção
+    Concurrent_Observer::Statistics queueStatistics();
 
 private:
     Protocol* _protocol;  // Ponteiro para o protocolo utilizado
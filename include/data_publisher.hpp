@@ -1,59 +1,160 @@
 #pragma once
 
-#include <thread>
 #include <mutex>
-#include <condition_variable>
 #include <chrono>
 #include <vector>
 #include <unordered_map>
+#include <memory>
+#include <functional>
 
 #include "../include/ethernet.hpp"
 #include "../include/communicator.hpp"
 #include "../include/message.hpp"
 #include "../include/observer.hpp"
+#include "../include/read_mostly.hpp"
+#include "../include/periodic_scheduler.hpp"
 
 // Classe responsável por gerenciar a entrega de mensagens periódicas para observadores interessados.
+// As publicações periódicas são disparadas por um PeriodicScheduler compartilhado
+// (poucas threads fixas), e não por uma thread por interesse.
 class DataPublisher {
-    // Estrutura que armazena os recursos de controle de uma thread periódica.
-    struct ThreadControl {
-        std::thread thread;                    // Thread que envia mensagens periodicamente.
-        Message message;                       // Mensagem que sera enviada periodicamente.
-        std::condition_variable* cv;           // Variável de condição usada para interromper a espera.
-        std::mutex* mtx;                       // Mutex usada junto da variável de condição.
-        bool* stop_flag;                       // Flag que sinaliza a thread para parar.
+    // Interesse periódico: a mensagem é entregue aos observadores a cada 'every' ticks do fluxo.
+    struct Interest {
+        MessageRef message;                            // Mensagem de interesse entregue periodicamente (cópia própria: não retém um buffer da NIC).
+        std::vector<Concurrent_Observer*> observers;   // Inscritos no tipo quando o interesse chegou.
+        uint64_t every;                                // Período do interesse / período base do fluxo.
+        uint64_t start;                                // Tick do fluxo em que o interesse entrou.
+        PeriodicScheduler::Clock::time_point expires;  // Fim da validade (max() sem lease).
+    };
+
+    // Fluxo periódico de um tipo: uma única tarefa no escalonador, no período base,
+    // atende todos os interesses cujo período é múltiplo dele (períodos harmônicos).
+    struct Stream {
+        Ethernet::Type type;
+        Ethernet::Period base;                 // Período base em milissegundos.
+        PeriodicScheduler::Handle handle = 0;  // Tarefa no escalonador.
+        std::mutex mutex;                      // Protege os interesses e o tick.
+        uint64_t tick = 0;                     // Disparos do fluxo até agora.
+        std::vector<Interest> interests;
+    };
+
+    // Tabela de tipo -> componentes inscritos (endereçamento aberto com sondagem linear).
+    // Cada inscrição/cancelamento altera uma cópia da tabela; as listas de inscritos
+    // são imutáveis e compartilhadas entre as cópias, então só as dos tipos
+    // alterados são refeitas.
+    class SubscriptionTable {
+    public:
+        typedef std::vector<Concurrent_Observer*> Observers;
+
+        // Retorna os inscritos no tipo (nullptr se não houver nenhum)
+        const Observers* find(Ethernet::Type type) const;
+
+        void add(Concurrent_Observer* observer, const std::vector<Ethernet::Type>& types);
+        void remove(Concurrent_Observer* observer, const std::vector<Ethernet::Type>& types);
+
+    private:
+        struct Entry {
+            bool used = false;
+            Ethernet::Type type = 0;
+            std::shared_ptr<const Observers> observers;
+        };
+
+        size_t position(Ethernet::Type type) const;
+        void reserve(size_t types);
+
+        std::vector<Entry> entries;  // Capacidade potência de 2, no máximo metade ocupada
+        size_t used = 0;             // Entradas ocupadas
     };
 
 public:
+    // Contadores dos fluxos periódicos (custo das trocas de grupo incluído).
+    struct Statistics {
+        size_t live_streams = 0;           // Fluxos (tarefas no escalonador) ativos.
+        size_t live_interests = 0;         // Interesses periódicos ativos.
+        uint64_t streams_created = 0;
+        uint64_t streams_retired = 0;
+        uint64_t interests_retired = 0;    // Por cancelamento, lease, troca de grupo ou unsubscribe.
+        uint64_t group_retirements = 0;    // Chamadas de delete_group_threads.
+        std::chrono::microseconds last_group_retirement{0};   // Duração da última.
+        std::chrono::microseconds max_group_retirement{0};    // Maior duração.
+
+        // Disparos dos fluxos, acumulados desde a criação (inclui os fluxos já encerrados).
+        uint64_t releases = 0;
+        uint64_t deadline_misses = 0;
+        std::chrono::microseconds max_jitter{0};
+        std::chrono::microseconds mean_jitter{0};
+    };
+
+    // 'publisher_threads' threads disparam todas as publicações periódicas.
+    explicit DataPublisher(unsigned int publisher_threads = 2);
+
     // Permite que um componente se inscreva para receber mensagens de certos tipos.
     void subscribe(Concurrent_Observer* obsCommunicator, std::vector<Ethernet::Type>* types);
 
-    // Cancela a inscrição de um componente e encerra suas threads periódicas.
+    // Cancela a inscrição de um componente e encerra suas publicações periódicas.
     void unsubscribe(Concurrent_Observer* obsCommunicator);
 
     // Recebe uma nova mensagem e distribui para os componentes interessados.
-    void notify(Message message);
+    void notify(const MessageRef& message);
+
+    // Encerra todas as publicações periódicas externas destinadas a um determinado grupo.
+    // Ao retornar, nenhuma delas é mais entregue e os fluxos vazios foram liberados.
+    // Retorna o número de interesses encerrados.
+    size_t delete_group_threads(Ethernet::Quadrant_ID group_id);
 
-    // Encerra todas as threads periodicas associadas a um determinado grupo.
-    void delete_group_threads(Ethernet::Quadrant_ID group_id);
+    // Contadores de fluxos e interesses periódicos.
+    Statistics statistics() const;
+
+    // Jitter e perdas de prazo de cada fluxo periódico ativo (os totais acumulados estão em statistics()).
+    std::vector<PeriodicScheduler::Statistics> periodic_statistics() const;
 
 private:
-    // Cria uma thread periódica que envia uma mensagem a um observador em intervalos fixos.
-    void create_periodic_thread(Concurrent_Observer* obsCommunicator, Message message);
+    // Agenda o envio periódico de uma mensagem aos observadores, no fluxo do seu tipo.
+    // Um novo interesse do mesmo consumidor no mesmo tipo renova (mesmo período) ou substitui o anterior.
+    void create_periodic_stream(const SubscriptionTable::Observers& observers, const MessageRef& message);
+
+    // Encerra os interesses do remetente no tipo indicado pela mensagem TYPE_INTEREST_CANCEL.
+    void cancel_interest(const MessageRef& message);
 
-    // Encerra e remove todas as threads periódicas associadas a um observador.
-    void delete_periodic_thread(Concurrent_Observer* obsCommunicator);
+    // Remove os interesses para os quais 'retire' retorna true e encerra os fluxos que ficarem vazios.
+    // 'retire' pode também alterar os observadores do interesse.
+    // Retorna o número de interesses removidos.
+    size_t retire_interests(const std::function<bool(Interest&)>& retire);
 
-    // Função que roda em cada thread periódica, enviando mensagens até receber sinal de parada.
-    void publish_loop(std::condition_variable* cv, std::mutex* mtx, bool* stop_flag,
-                      Concurrent_Observer* obsCommunicator, Message message,
-                      std::chrono::milliseconds period_ms);
+    // Dispara um tick do fluxo: entrega os interesses que vencem nele (e ainda não expiraram).
+    static void publish(Stream& stream);
+
+    // Intervalo entre as remoções dos interesses com lease vencido.
+    static constexpr std::chrono::milliseconds LEASE_SWEEP_PERIOD{100};
 
 private:
-    // Mapeia cada observador aos tipos de mensagens que ele deseja receber.
-    std::unordered_map<Concurrent_Observer*, std::vector<Ethernet::Type>*> subscribers;
+    // Mapeia cada observador aos tipos de mensagens que ele deseja receber (cópia da lista inscrita).
+    std::unordered_map<Concurrent_Observer*, std::vector<Ethernet::Type>> subscribers;
     std::mutex subscribers_mutex; // Protege o acesso ao mapa de inscritos.
 
-    // Mapeia cada observador às threads que estão enviando mensagens periodicamente para ele.
-    std::unordered_map<Concurrent_Observer*, std::vector<ThreadControl>> threads;
-    std::mutex threads_mutex; // Protege o acesso ao mapa de threads.
+    // Índice por tipo montado a partir de 'subscribers', lido sem locks pelo notify.
+    ReadMostly<SubscriptionTable> subscriptions;
+
+    // Fluxos periódicos de cada tipo (um por período base distinto).
+    std::unordered_map<Ethernet::Type, std::vector<std::shared_ptr<Stream>>> streams;
+    mutable std::mutex streams_mutex; // Protege o acesso ao mapa de fluxos.
+    PeriodicScheduler::Handle lease_sweeper = 0; // Tarefa que remove interesses expirados (criada com o primeiro lease).
+
+    // Contadores (protegidos por streams_mutex).
+    size_t live_interests = 0;
+    uint64_t streams_created = 0;
+    uint64_t streams_retired = 0;
+    uint64_t interests_retired = 0;
+    uint64_t group_retirements = 0;
+    std::chrono::microseconds last_group_retirement{0};
+    std::chrono::microseconds max_group_retirement{0};
+
+    // Disparos dos fluxos já encerrados (protegidos por streams_mutex).
+    uint64_t retired_releases = 0;
+    uint64_t retired_deadline_misses = 0;
+    std::chrono::microseconds retired_max_jitter{0};
+    std::chrono::microseconds retired_total_jitter{0};
+
+    // Dispara as publicações periódicas (destruído primeiro, parando as threads).
+    PeriodicScheduler scheduler;
 };
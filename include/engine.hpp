@@ -2,42 +2,100 @@
 
 #include <functional>
 #include <string>
-#include <queue>
 #include <mutex>
-#include <condition_variable>
 #include <thread>
 #include <vector>
-#include <semaphore.h>
+#include <cstdint>
+#include <sys/socket.h>
+#include <linux/if_packet.h>
+
+#include "socket_filter.hpp"
 
 class Engine {
 public:
     using Callback = std::function<void(const void*, size_t)>;
 
+    // Receive strategy used by the engine (both are driven by the shared Reactor)
+    enum class ReceiveMode {
+        SOCKET, // recvfrom() per frame into a stack buffer
+        RING    // PACKET_MMAP (TPACKET_V3) ring, frames handed to the callback straight from the ring blocks
+    };
+
+    // Engine configuration
+    struct Config {
+        ReceiveMode receive_mode = ReceiveMode::RING;
+        unsigned int ring_block_size = 1 << 20;  // Bytes per ring block (power of two, multiple of the page size)
+        unsigned int ring_block_count = 16;      // Number of blocks in the ring
+        unsigned int ring_frame_size = 2048;     // Nominal frame slot size (only used to size tp_frame_nr)
+        unsigned int ring_block_timeout_ms = 1;  // Time after which the kernel retires a partially filled block
+        unsigned int tx_batch_size = 32;         // Frames queued inside a batch before an automatic flush
+        uint16_t protocol_filter = 0x88B5;       // EtherType accepted by the kernel filter (0 accepts any)
+        bool drop_outgoing = false;              // Drop frames sent from this host in the kernel
+        unsigned int fanout = 1;                 // Receive sockets joined by PACKET_FANOUT (1 disables fanout)
+        uint32_t fanout_key_offset = 8;          // Offset of the 4 frame bytes that select the socket (end of the source MAC)
+    };
+
     // Construtor com callback opcional
     Engine(const std::string& interface, Callback callback = nullptr, bool enable_receive = false);
+    Engine(const std::string& interface, Callback callback, bool enable_receive, const Config& config);
 
     ~Engine();
 
     int send(const void* data, size_t size);
+
+    // Transmit batching: while a batch is open, send() queues frames and they
+    // are written with a single sendmmsg() on flush(), when the queue fills up
+    // or when the outermost batch is closed. Batches may be nested and are
+    // shared by every thread using the engine.
+    void begin_batch();
+    int end_batch();
+    int flush();
+
+    // Kernel-side (SO_ATTACH_FILTER) filtering of received frames.
+    // default_filter() returns the filter built from the Config, which callers may extend.
+    SocketFilter default_filter() const;
+    bool set_filter(const SocketFilter& filter);
+
     static void set_thread_priority(std::thread& thread, int policy, int priority);
 
 private:
     std::string _interface;
     Callback _callback;
     int _socket;
+    Config _config;
+
+    // Receive channel: one socket with its own ring and reactor registration.
+    // Channel 0 is also the transmit socket; more channels exist only with fanout,
+    // where frames of one sender always land on the same channel (order is kept).
+    struct Channel {
+        int socket = -1;
+        uint8_t* ring = nullptr;      // RING mode only
+        size_t ring_size = 0;
+        unsigned int ring_block = 0;
+        uint64_t reactor_id = 0;      // 0 when receive is disabled
+    };
+    std::vector<Channel> channels;
+
+    void open_channel(Channel& channel, int ifindex, bool enable_receive);
+    void close_channel(Channel& channel);
+    bool join_fanout();
 
-    // Fila para armazenar os buffers recebidos
-    std::queue<std::pair<std::vector<char>, size_t>> buffer_queue;
-    std::mutex queue_mutex;
-    std::condition_variable queue_cv;
+    // Transmit state: interface index resolved once and a preallocated batch queue
+    static constexpr size_t TX_SLOT_SIZE = 2048;
+    struct sockaddr_ll _dest_addr {};
+    std::vector<uint8_t> tx_slots;
+    std::vector<struct iovec> tx_iov;
+    std::vector<struct mmsghdr> tx_msgs;
+    size_t tx_count = 0;
+    int tx_batch_depth = 0;
+    std::mutex tx_mutex;
 
-    // Thread para processar a fila
-    std::thread processing_thread;
-    bool stop_processing = false;
+    int send_now(const void* data, size_t size);
+    int flush_locked();
 
-    void receive_loop();
-    void process_queue();
+    bool setup_ring(Channel& channel);
 
-    // SIGIO signal handler
-    static void sigio_handler(int signum);
-};
\ No newline at end of file
+    // Reactor handlers: deliver every frame available on a channel
+    void receive_ring(Channel& channel);
+    void receive_socket(Channel& channel);
+};
@@ -19,6 +19,7 @@ public:
     using Timestamp = uint64_t;                 // (8 bytes)
     using MAC_key = std::array<uint8_t, 16>;    // (16 bytes)
     using Quadrant_ID = uint8_t;                // (1 byte)
+    using Length = uint16_t;                    // (2 bytes)
 
     // Tipos de dados utilizados pelo Time Synchronization Manager (PTP - IEEE 1588).
     Ethernet::Type constexpr static TYPE_PTP_SYNC = 0x0;        // (4 bytes) Tipo de dado PTP Sync
@@ -32,6 +33,10 @@ public:
     // Tipo de dado enviado pelos componentes que fornecem a posicao dos veiculo.
     Ethernet::Type constexpr static TYPE_POSITION_DATA = 0x0D;
 
+    // Tipo de dado enviado por um consumidor (com destino ao componente 0) para cancelar
+    // seus interesses periódicos em um tipo. Os dados são o Ethernet::Type cancelado.
+    Ethernet::Type constexpr static TYPE_INTEREST_CANCEL = 0x0E;
+
     // Estrturua de dados para envio da Localizacao dos veiculos.
     struct Position {
         int x;
@@ -46,6 +51,12 @@ public:
         int y_max;
     };
 
+    // Dados opcionais de uma mensagem de interesse periódico.
+    // Com lease_ms > 0 o interesse expira se não for reenviado (renovado) dentro desse prazo.
+    struct InterestLease {
+        uint32_t lease_ms = 0;  // Validade do interesse em milissegundos (0 = até o cancelamento)
+    } __attribute__((packed));
+
     // Estrutura para armazenar o endereço dos componentes do veículo.
     struct Address { // (14 bytes)
         Mac_Address vehicle_id = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00}; // Endereço MAC (identificador do carro) (6 bytes) // // Inicializa com valor inexistente
@@ -67,34 +78,36 @@ public:
     } __attribute__((packed));
 
     // Estrutura para armazenar o cabeçalho de comunicação externa.
-    struct ExternalHeader { // (59 bytes)
+    struct ExternalHeader { // (61 bytes)
         Address src_address;        // Endereço de origem (14 bytes)
         Address dst_address;        // Endereço de destino (14 bytes)
         Type type;                  // Tipo do dado (4 bytes)
         Period period = 0;          // Período de transmissão em milissegundos (max 65s) (2 bytes)
         Timestamp timestamp;        // Timestamp do envio da mensagem (8 bytes)
+        Length length = 0;          // Quantidade de bytes de dados que seguem o cabeçalho (2 bytes)
         MAC_key mac = {0};          // Message Authentication Code (16 bytes)
         Quadrant_ID quadrant_id;    // Identificador do quadrante (1 byte)
     } __attribute__((packed));
  
     // Estrutura para armazenar o payload da aplicação de comunicação externa.
     struct ExternalPayload {
-        ExternalHeader header;  // Cabeçalho da aplicacao 59 bytes
-        uint8_t data[1427];     // Mensagem a ser transmitida 1427 bytes
+        ExternalHeader header;  // Cabeçalho da aplicacao 61 bytes
+        uint8_t data[1425];     // Mensagem a ser transmitida (até 1425 bytes)
     } __attribute__((packed));
 
     // Estrutura para armazenar o cabeçalho de comunicação interna.
-    struct InternalHeader { // (22 bytes)
+    struct InternalHeader { // (24 bytes)
         Thread_ID src_component_id = (pthread_t)0;  // ID do Componente de origem (8 bytes)
         Thread_ID dst_component_id = (pthread_t)0;  // ID do Componente de destino (8 bytes)
         Type type;                                  // Tipo do dado (4 bytes)
         Period period = 0;                          // Período de transmissão em milissegundos (max 65s) (2 bytes)
+        Length length = 0;                          // Quantidade de bytes de dados que seguem o cabeçalho (2 bytes)
     } __attribute__((packed));
 
     // Estrutura para armazenar o payload da aplicação de comunicação interna.
     struct InternalPayload {
-        InternalHeader header;  // Cabeçalho da aplicacao 22 bytes
-        uint8_t data[1464];     // Mensagem a ser transmitida 1464 bytes
+        InternalHeader header;  // Cabeçalho da aplicacao 24 bytes
+        uint8_t data[1462];     // Mensagem a ser transmitida (até 1462 bytes)
     } __attribute__((packed));
 
     // Tamanho do cabeçalho Ethernet em bytes (destino + origem + tipo)
@@ -103,6 +116,12 @@ public:
     // Tamanho máximo do payload (MTU padrão - tamanho do cabeçalho)
     static constexpr size_t MAX_PAYLOAD = 1500 - HEADER_SIZE;
 
+    // Deslocamentos (a partir do inicio do frame) dos campos do cabecalho externo usados em filtros.
+    static constexpr size_t SRC_VEHICLE_OFFSET = HEADER_SIZE + offsetof(ExternalHeader, src_address) + offsetof(Address, vehicle_id);
+    static constexpr size_t DST_VEHICLE_OFFSET = HEADER_SIZE + offsetof(ExternalHeader, dst_address) + offsetof(Address, vehicle_id);
+    static constexpr size_t TYPE_OFFSET = HEADER_SIZE + offsetof(ExternalHeader, type);
+    static constexpr size_t QUADRANT_ID_OFFSET = HEADER_SIZE + offsetof(ExternalHeader, quadrant_id);
+
     // Estrutura do frame Ethernet.
     struct Frame {
         Mac_Address dst = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}; // Endereço MAC de destino (sempre broadcast)
@@ -114,41 +133,53 @@ public:
         static constexpr size_t mtu() { return MAX_PAYLOAD; }
     } __attribute__((packed));
 
-    // Metodo para preencher o payload do frame de comunicação interna.
-    bool fillInternalPayload(Ethernet::Frame* frame, const Ethernet::InternalPayload* payload) {
-        size_t payload_size = sizeof(Ethernet::InternalPayload);
-        // Verifica se o tamanho do payload não excede o máximo permitido
-        if (payload_size > Ethernet::MAX_PAYLOAD) {
-            std::cerr << "Payload size exceeds maximum allowed size: " << payload_size << " > " << Ethernet::MAX_PAYLOAD << std::endl;
+    // Tamanho do frame com o cabeçalho interno e 'size' bytes de dados.
+    static constexpr size_t internalFrameSize(size_t size) { return HEADER_SIZE + sizeof(InternalHeader) + size; }
+
+    // Tamanho do frame com o cabeçalho externo e 'size' bytes de dados.
+    static constexpr size_t externalFrameSize(size_t size) { return HEADER_SIZE + sizeof(ExternalHeader) + size; }
+
+    // Metodo para preencher o payload do frame de comunicação interna (cabeçalho + apenas os dados usados).
+    bool fillInternalPayload(Ethernet::Frame* frame, const Ethernet::InternalHeader* header, const void* data, size_t size) {
+        // Verifica se os dados cabem no payload
+        if (size > sizeof(Ethernet::InternalPayload::data)) {
+            std::cerr << "Payload size exceeds maximum allowed size: " << size << " > " << sizeof(Ethernet::InternalPayload::data) << std::endl;
             return false;
         }
-        // Copiar a estrutura Payload para o vetor de bytes frame->payload
-        std::memcpy(frame->payload, payload, payload_size);
+        // Copia o cabeçalho e, logo após, os dados para o vetor de bytes frame->payload
+        std::memcpy(frame->payload, header, sizeof(Ethernet::InternalHeader));
+        std::memcpy(frame->payload + sizeof(Ethernet::InternalHeader), data, size);
         return true;
     }
 
-    // Metodo para preencher o payload do frame de comunicação externa.
-    bool fillExternalPayload(Ethernet::Frame* frame, const Ethernet::ExternalPayload* payload) {
-        size_t payload_size = sizeof(Ethernet::ExternalPayload);
-        // Verifica se o tamanho do payload não excede o máximo permitido
-        if (payload_size > Ethernet::MAX_PAYLOAD) {
-            std::cerr << "Payload size exceeds maximum allowed size: " << payload_size << " > " << Ethernet::MAX_PAYLOAD << std::endl;
+    // Metodo para preencher o payload do frame de comunicação externa (cabeçalho + apenas os dados usados).
+    bool fillExternalPayload(Ethernet::Frame* frame, const Ethernet::ExternalHeader* header, const void* data, size_t size) {
+        // Verifica se os dados cabem no payload
+        if (size > sizeof(Ethernet::ExternalPayload::data)) {
+            std::cerr << "Payload size exceeds maximum allowed size: " << size << " > " << sizeof(Ethernet::ExternalPayload::data) << std::endl;
             return false;
         }
-        // Copiar a estrutura Payload para o vetor de bytes frame->payload
-        std::memcpy(frame->payload, payload, payload_size);
+        // Copia o cabeçalho e, logo após, os dados para o vetor de bytes frame->payload
+        std::memcpy(frame->payload, header, sizeof(Ethernet::ExternalHeader));
+        std::memcpy(frame->payload + sizeof(Ethernet::ExternalHeader), data, size);
         return true;
     }
 
-    // Metodo para extrair o payload do frame de comunicação interna.
-    void extractInternalPayload(Ethernet::Frame* frame, Ethernet::InternalPayload* payload) {
-        // Copia o conteúdo do vetor de bytes frame->payload para a estrutura Payload
-        std::memcpy(payload, frame->payload, sizeof(Ethernet::InternalPayload));
+    // Metodo para ler o cabeçalho do frame de comunicação interna sem copiar os dados.
+    // Retorna um ponteiro para os 'length' bytes de dados dentro do frame, ou nullptr se o frame recebido ('size' bytes) estiver truncado.
+    const uint8_t* readInternalPayload(const Ethernet::Frame* frame, size_t size, Ethernet::InternalHeader* header) {
+        if (size < internalFrameSize(0)) return nullptr;
+        std::memcpy(header, frame->payload, sizeof(Ethernet::InternalHeader));
+        if (header->length > sizeof(Ethernet::InternalPayload::data) || internalFrameSize(header->length) > size) return nullptr;
+        return frame->payload + sizeof(Ethernet::InternalHeader);
     }
 
-    // Metodo para extrair o payload do frame de comunicação externa.
-    void extractExternalPayload(Ethernet::Frame* frame, Ethernet::ExternalPayload* payload) {
-        // Copia o conteúdo do vetor de bytes frame->payload para a estrutura Payload
-        std::memcpy(payload, frame->payload, sizeof(Ethernet::ExternalPayload));
+    // Metodo para ler o cabeçalho do frame de comunicação externa sem copiar os dados.
+    // Retorna um ponteiro para os 'length' bytes de dados dentro do frame, ou nullptr se o frame recebido ('size' bytes) estiver truncado.
+    const uint8_t* readExternalPayload(const Ethernet::Frame* frame, size_t size, Ethernet::ExternalHeader* header) {
+        if (size < externalFrameSize(0)) return nullptr;
+        std::memcpy(header, frame->payload, sizeof(Ethernet::ExternalHeader));
+        if (header->length > sizeof(Ethernet::ExternalPayload::data) || externalFrameSize(header->length) > size) return nullptr;
+        return frame->payload + sizeof(Ethernet::ExternalHeader);
     }
 };
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs short tasks on a small fixed pool of threads shared by many components.
+// Tasks run in FIFO order on any pool thread, possibly concurrently. The task
+// queue is unbounded, so callers bound what they post: AsyncCommunicator keeps
+// at most one task per message in its own bounded queue. Tasks must not block
+// for long: each one holds a pool thread while it runs.
+class Executor {
+public:
+    typedef std::function<void()> Task;
+
+    // Counters of the pool
+    struct Statistics {
+        uint64_t tasks_run = 0;
+        size_t high_water = 0;      // Largest number of tasks waiting for a thread
+        unsigned int threads = 0;
+    };
+
+    // 'threads' pool threads are started with the first task
+    explicit Executor(unsigned int threads = 2);
+
+    // Runs the tasks still queued, then stops the pool
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // Changes the pool size; only possible before the first task. Returns false otherwise.
+    bool set_thread_count(unsigned int threads);
+
+    void post(Task task);
+
+    // True when called from one of this executor's pool threads (a task that
+    // waits for other tasks of the pool there may wait for itself)
+    bool in_pool() const;
+
+    Statistics statistics() const;
+
+private:
+    void run();
+
+    unsigned int thread_count;
+    std::vector<std::thread> threads;
+    std::deque<Task> tasks;
+    bool stopping = false;
+    Statistics stats;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;   // New task or shutdown
+};
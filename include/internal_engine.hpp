@@ -2,24 +2,53 @@
 #define INTERNAL_ENGINE_HPP
 
 #include <thread>
-#include <mutex>
-#include <condition_variable>
-#include <queue>
-#include <vector>
+#include <atomic>
+#include <memory>
 #include <functional>
 #include <string>
+#include <cstdint>
 
 // Define a callback type
 using Callback = std::function<void(const void*, size_t)>;
 
+// Engine for the frames exchanged between components of the same vehicle.
+// Senders copy each frame into a preallocated slot of a bounded ring and
+// publish it with a per-slot sequence number, so any number of threads may
+// send at once without locks or allocations. A single processing thread
+// hands the frames to the callback straight from the ring and sleeps on a
+// futex only when the ring is empty; senders only make a syscall to wake it
+// up. What happens when the ring is full is chosen by the overflow policy.
 class InternalEngine {
 public:
+    // What send() does when the ring is full
+    enum class Overflow {
+        BLOCK,          // Wait for a free slot
+        DROP_OLDEST,    // Discard the oldest queued frame and enqueue the new one
+        DROP_NEWEST     // Discard the new frame (send returns -1)
+    };
+
+    // Engine configuration
+    struct Config {
+        unsigned int slot_count = 1024;      // Frames kept in the ring, power of two
+        unsigned int slot_size = 1536;       // Maximum frame size
+        Overflow overflow = Overflow::BLOCK;
+    };
+
+    // Counters of this engine
+    struct Statistics {
+        uint64_t frames_sent = 0;          // Frames enqueued
+        uint64_t frames_delivered = 0;     // Frames handed to the callback
+        uint64_t frames_dropped = 0;       // New frames refused on a full ring (DROP_NEWEST)
+        uint64_t frames_overwritten = 0;   // Queued frames discarded on a full ring (DROP_OLDEST)
+        uint64_t sender_waits = 0;         // Times a sender slept on a full ring (BLOCK)
+    };
 
     // Existing constructor
     InternalEngine(Callback callback);
 
     // New constructor to match NIC's requirements
     InternalEngine(const std::string& interface, Callback callback, bool flag);
+    InternalEngine(const std::string& interface, Callback callback, bool flag, const Config& config);
 
     // Destructor
     ~InternalEngine();
@@ -27,25 +56,50 @@ public:
     // Method to enqueue data for processing
     int send(const void* data, size_t size);
 
+    Statistics statistics() const;
+
 private:
+    struct Slot;
+
     // Method to process the queue
     void process_queue();
 
+    Slot* slot(uint64_t position) const;
+    bool try_enqueue(const void* data, size_t size);
+    bool discard_oldest();
+    bool deliver_pending();
+
     // Callback function for processing data
     Callback _callback;
+    Config _config;
 
-    // Thread for processing the queue
-    std::thread processing_thread;
+    // Ring of slots; each one is a Slot header followed by slot_size bytes of frame
+    std::unique_ptr<uint8_t[]> slots;
+    size_t slot_stride = 0;
 
-    // Queue to hold data (shared internal memory)
-    std::queue<std::pair<std::vector<char>, size_t>> buffer_queue;
+    // Next position to fill and next position to deliver (senders and the
+    // processing thread touch different cache lines)
+    alignas(64) uint64_t enqueue_position = 0;
+    alignas(64) uint64_t dequeue_position = 0;
 
-    // Mutex and condition variable for thread synchronization
-    std::mutex queue_mutex;
-    std::condition_variable queue_cv;
+    // Futex words: 'items' changes when a frame is published for a sleeping
+    // processing thread, 'space' when a slot is freed for sleeping senders
+    alignas(64) uint32_t items = 0;
+    uint32_t consumer_waiting = 0;
+    alignas(64) uint32_t space = 0;
+    uint32_t space_waiters = 0;
+
+    // Thread for processing the queue
+    std::thread processing_thread;
 
     // Flag to stop the processing thread
-    bool stop_processing;
+    std::atomic<bool> stop_processing{false};
+
+    std::atomic<uint64_t> frames_sent{0};
+    std::atomic<uint64_t> frames_delivered{0};
+    std::atomic<uint64_t> frames_dropped{0};
+    std::atomic<uint64_t> frames_overwritten{0};
+    std::atomic<uint64_t> sender_waits{0};
 };
 
-#endif // INTERNAL_ENGINE_HPP
\ No newline at end of file
+#endif // INTERNAL_ENGINE_HPP
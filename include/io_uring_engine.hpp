@@ -0,0 +1,114 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <sys/socket.h>
+#include <linux/if_packet.h>
+#include <linux/io_uring.h>
+
+#include "socket_filter.hpp"
+
+// io_uring engine, an alternative to Engine for NIC<IoUringEngine>.
+// Receive posts one multishot recvmsg on the raw socket, with frames landing
+// in a provided buffer ring, so the kernel keeps delivering without a new
+// submission per frame. Sends are queued as SQEs in a second ring and
+// submitted one at a time, or all together when a batch closes.
+class IoUringEngine {
+public:
+    using Callback = std::function<void(const void*, size_t)>;
+
+    // Engine configuration
+    struct Config {
+        unsigned int buffer_count = 1024;      // Provided receive buffers, power of two
+        unsigned int buffer_size = 2048;       // Bytes per receive buffer (frame plus io_uring_recvmsg_out)
+        unsigned int tx_slots = 256;           // Send buffers in flight (also the send ring size), power of two
+        uint16_t protocol_filter = 0x88B5;     // EtherType accepted by the kernel filter (0 accepts any)
+        bool drop_outgoing = false;            // Drop frames sent from this host in the kernel
+    };
+
+    IoUringEngine(const std::string& interface, Callback callback = nullptr, bool enable_receive = false);
+    IoUringEngine(const std::string& interface, Callback callback, bool enable_receive, const Config& config);
+
+    ~IoUringEngine();
+
+    int send(const void* data, size_t size);
+
+    // Transmit batching: while a batch is open send() only fills SQEs, which
+    // are submitted with a single io_uring_enter() when the outermost batch
+    // closes or the send ring fills up.
+    void begin_batch();
+    int end_batch();
+    int flush();
+
+    // Kernel-side (SO_ATTACH_FILTER) filtering of received frames, as in Engine
+    SocketFilter default_filter() const;
+    bool set_filter(const SocketFilter& filter);
+
+private:
+    // Submission and completion queues of one io_uring instance
+    struct Ring {
+        int fd = -1;
+        void* sq_map = nullptr;
+        size_t sq_map_size = 0;
+        void* cq_map = nullptr;
+        size_t cq_map_size = 0;
+        struct io_uring_sqe* sqes = nullptr;
+        size_t sqes_size = 0;
+        uint32_t* sq_head = nullptr;
+        uint32_t* sq_tail = nullptr;
+        uint32_t sq_mask = 0;
+        uint32_t sq_entries = 0;
+        uint32_t* sq_array = nullptr;
+        uint32_t* sq_flags = nullptr;
+        uint32_t* cq_head = nullptr;
+        uint32_t* cq_tail = nullptr;
+        uint32_t cq_mask = 0;
+        struct io_uring_cqe* cqes = nullptr;
+        uint32_t to_submit = 0;      // SQEs written but not yet submitted
+    };
+
+    std::string _interface;
+    Callback _callback;
+    int _socket = -1;
+    Config _config;
+
+    // Receive state: multishot recvmsg fed by a provided buffer ring
+    static constexpr uint16_t BUFFER_GROUP = 0;
+    static constexpr uint64_t RECV_TAG = ~0ULL;
+    Ring rx;
+    struct msghdr recv_msg {};
+    uint8_t* buffers = nullptr;
+    size_t buffers_size = 0;
+    struct io_uring_buf_ring* buf_ring = nullptr;
+    size_t buf_ring_size = 0;
+    uint64_t _reactor_id = 0;
+
+    // Transmit state: send ring and its preallocated slots
+    static constexpr size_t TX_SLOT_SIZE = 2048;
+    Ring tx;
+    struct sockaddr_ll _dest_addr {};
+    std::vector<uint8_t> tx_buffers;
+    std::vector<struct iovec> tx_iov;
+    std::vector<struct msghdr> tx_msgs;
+    std::vector<uint32_t> tx_free;
+    int tx_batch_depth = 0;
+    std::mutex tx_mutex;
+
+    bool setup_ring(Ring& ring, unsigned int entries, unsigned int cq_entries = 0);
+    void close_ring(Ring& ring);
+    struct io_uring_sqe* get_sqe(Ring& ring);
+    int submit(Ring& ring, unsigned int wait);
+
+    bool setup_receive();
+    void post_receive();
+    void recycle_buffer(uint16_t id);
+
+    void reap_sends();
+    int flush_locked();
+
+    // Reactor handler: processes every completion of the receive ring
+    void receive_completions();
+};
@@ -4,6 +4,9 @@
 #include <cstring>
 #include <chrono>
 #include <iostream>
+#include <atomic>
+#include <memory>
+#include <utility>
 
 #include "ethernet.hpp"
 
@@ -11,10 +14,10 @@
 class Message {
 public:
     // Tamanho máximo da mensagem (em bytes)
-    static constexpr size_t MAX_SIZE = 1427; // 1500 - 14 (tamanho do cabeçalho Ethernet) - 59 (tamanho header)
+    static constexpr size_t MAX_SIZE = sizeof(Ethernet::ExternalPayload::data); // 1500 - 14 (tamanho do cabeçalho Ethernet) - 61 (tamanho header)
     
     // Construtor: inicializa a mensagem com tamanho zero
-    Message() : _size(MAX_SIZE) {}
+    Message() : _size(0) {}
     
     // Retorna um ponteiro constante para os dados (para leitura)
     const uint8_t* data() const {
@@ -124,8 +127,10 @@ public:
     }
 
 private:
+    friend class MessageRef;
+
     // Gera MAC usando o cabeçalho da mensagem (exeto campo mac) e a chave doo grupo.
-    Ethernet::MAC_key generate_mac(const Ethernet::ExternalHeader& header, const Ethernet::MAC_key group_key) {
+    static Ethernet::MAC_key generate_mac(const Ethernet::ExternalHeader& header, const Ethernet::MAC_key group_key) {
         // Faz XOR dos bytes do cabeçalho (exeto mac) com a chave do grupo.
         Ethernet::MAC_key mac;
 
@@ -155,5 +160,177 @@ private:
     // Buffer que armazena os dados da mensagem
     uint8_t _data[MAX_SIZE];
     // Tamanho real da mensagem armazenada
-    size_t _size = MAX_SIZE;
+    size_t _size = 0;
+};
+
+
+// Cabeçalho e dados de uma mensagem recebida, guardados junto do frame que os
+// contém (o Buffer da NIC). O Protocol preenche os campos uma única vez antes de
+// publicar a mensagem; depois eles são apenas lidos pelas MessageRef. Quando a
+// última referência é destruída, recycle() devolve a memória ao seu dono.
+class MessageStorage {
+public:
+    Ethernet::ExternalHeader header;        // Cabeçalho (timestamp em microssegundos, como em Message)
+    Ethernet::MAC_key group_key = {0};      // Chave do grupo (usada no MAC de mensagens internas)
+    const uint8_t* data = nullptr;          // Dados da mensagem, dentro do frame
+    size_t data_size = 0;                   // Tamanho dos dados
+
+    // Adiciona uma referência
+    void retain() {
+        refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Remove uma referência e recicla a memória se for a última
+    void release() {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            recycle();
+        }
+    }
+
+    // Verifica se a memória da mensagem é escassa (ex.: pool de buffers da NIC
+    // quase esgotado): quem for guardar a mensagem deve guardar uma cópia.
+    virtual bool scarce() const {
+        return false;
+    }
+
+protected:
+    ~MessageStorage() = default;
+
+    // Devolve a memória ao dono (chamado quando não há mais referências)
+    virtual void recycle() = 0;
+
+private:
+    std::atomic<unsigned int> refs{0};
+};
+
+// Cópia de uma mensagem em memória própria, sem o buffer da NIC. Usada por quem
+// guarda mensagens por muito tempo, para não reter os buffers usados nos envios.
+class HeapMessage final : public MessageStorage {
+public:
+    explicit HeapMessage(const MessageStorage& source) : bytes(new uint8_t[source.data_size]) {
+        header = source.header;
+        group_key = source.group_key;
+        std::memcpy(bytes.get(), source.data, source.data_size);
+        data = bytes.get();
+        data_size = source.data_size;
+    }
+
+protected:
+    void recycle() override {
+        delete this;
+    }
+
+private:
+    ~HeapMessage() = default;
+
+    std::unique_ptr<uint8_t[]> bytes;
+};
+
+// Referência imutável e compartilhada a uma mensagem recebida. Copiar uma
+// MessageRef apenas incrementa a contagem de referências: os dados continuam no
+// frame recebido pela NIC do Protocol até o Communicator, sem cópias.
+class MessageRef {
+public:
+    MessageRef() = default;
+
+    // Passa a referenciar 'storage' (já preenchido)
+    explicit MessageRef(MessageStorage* storage) : _storage(storage) {
+        if (_storage) _storage->retain();
+    }
+
+    MessageRef(const MessageRef& other) : MessageRef(other._storage) {}
+
+    MessageRef(MessageRef&& other) noexcept : _storage(other._storage) {
+        other._storage = nullptr;
+    }
+
+    MessageRef& operator=(MessageRef other) noexcept {
+        std::swap(_storage, other._storage);
+        return *this;
+    }
+
+    ~MessageRef() {
+        if (_storage) _storage->release();
+    }
+
+    // Retorna se a referência aponta para uma mensagem
+    explicit operator bool() const {
+        return _storage != nullptr;
+    }
+
+    // Retorna uma referência a uma cópia da mensagem em memória própria (HeapMessage)
+    MessageRef copy() const {
+        return _storage ? MessageRef(new HeapMessage(*_storage)) : MessageRef();
+    }
+
+    // Retorna a referência a guardar em uma fila: a própria mensagem ou, se a
+    // memória dela estiver escassa, uma cópia (o buffer da NIC fica livre).
+    MessageRef hold() const {
+        return (_storage && _storage->scarce()) ? copy() : *this;
+    }
+
+    // Retorna um ponteiro somente leitura para os dados
+    const uint8_t* data() const {
+        return _storage->data;
+    }
+
+    // Retorna o tamanho dos dados
+    size_t size() const {
+        return _storage->data_size;
+    }
+
+    // Retorna o endereco de origem da mensagem
+    Ethernet::Address getSrcAddress() const {
+        return _storage->header.src_address;
+    }
+
+    // Retorna o endereço de destino da mensagem
+    Ethernet::Address getDstAddress() const {
+        return _storage->header.dst_address;
+    }
+
+    // Retorna o tipo da mensagem
+    Ethernet::Type getType() const {
+        return _storage->header.type;
+    }
+
+    // Retorna o periodo de transmissao da mensagem
+    Ethernet::Period getPeriod() const {
+        return _storage->header.period;
+    }
+
+    // Retorna o timestamp da mensagem
+    std::chrono::system_clock::time_point getTimestamp() const {
+        return std::chrono::system_clock::time_point(std::chrono::microseconds(_storage->header.timestamp));
+    }
+
+    // Retorna o identificador do grupo
+    Ethernet::Quadrant_ID getGroupID() const {
+        return _storage->header.quadrant_id;
+    }
+
+    // Retorna o MAC da mensagem (gerado com a chave do grupo se for interna e não tiver MAC)
+    Ethernet::MAC_key getMAC() const {
+        const Ethernet::ExternalHeader& header = _storage->header;
+        Ethernet::MAC_key key = {0};
+        if (header.src_address.vehicle_id == header.dst_address.vehicle_id && header.mac == key) {
+            return Message::generate_mac(header, _storage->group_key);
+        }
+        return header.mac;
+    }
+
+    // Copia cabeçalho e dados para uma Message (que pode então ser alterada)
+    void copyTo(Message* message) const {
+        message->setSrcAddress(getSrcAddress());
+        message->setDstAddress(getDstAddress());
+        message->setType(getType());
+        message->setPeriod(getPeriod());
+        message->setTimestamp(getTimestamp());
+        message->setGroupID(getGroupID());
+        message->setMAC(getMAC());
+        message->setData(data(), size());
+    }
+
+private:
+    MessageStorage* _storage = nullptr;
 };
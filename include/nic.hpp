@@ -8,24 +8,43 @@
 #include "observer.hpp"
 #include "message.hpp"
 #include "engine.hpp"
+#include "xdp_engine.hpp"
+#include "io_uring_engine.hpp"
+#include "sim_engine.hpp"
+#include "shm_engine.hpp"
 #include "internal_engine.hpp"
+#include "buffer_pool.hpp"
 
 
-template <typename Engine>
-class NIC : public Ethernet {
+// Parte da NIC independente da Engine: buffers, endereço, estatísticas e observadores.
+// O Protocol usa apenas esta interface, de modo que qualquer NIC<Engine> pode ser utilizada.
+// Os Buffers de envio e de recebimento vêm de um pool fixo da NIC (sem malloc/free por frame).
+class NIC_Base : public Ethernet {
 public:
     typedef Ethernet::Frame Frame;                    // Tipo para frames Ethernet
     typedef Ethernet::Mac_Address Mac_Address;        // Tipo para endereços MAC
     typedef Ethernet::Protocol_Number Protocol_Number; // Tipo para números de protocolo
     
-    // Buffer para armazenar frames Ethernet recebidos
-    class Buffer {
+    // Buffer para armazenar frames Ethernet recebidos.
+    // Em um frame recebido (ou em uma mensagem interna entregue diretamente pelo Protocol),
+    // também guarda a mensagem (MessageStorage): o buffer volta para a NIC quando a
+    // última MessageRef é destruída. Envio e recebimento usam o mesmo pool; para que
+    // mensagens retidas não impeçam os envios, filas e interesses copiam a mensagem
+    // (MessageRef::hold) quando restam só os blocos da reserva do pool.
+    class Buffer final : public MessageStorage {
     public:
         Frame frame;   // O frame Ethernet
         size_t size;   // Tamanho do payload
+        NIC_Base* owner = nullptr;  // NIC dona do buffer (para devolvê-lo ao pool)
         
         Buffer();
         Buffer(const Frame& f, size_t s);
+
+        // Escassa com o pool baixo: mensagens guardadas são copiadas para preservar a reserva de envio
+        bool scarce() const override;
+
+    protected:
+        void recycle() override;
     };
     
     // Estrutura para armazenar estatísticas da interface de rede
@@ -36,27 +55,64 @@ public:
         size_t rx_bytes;    // Bytes recebidos
         size_t errors;      // Erros ocorridos
     };
-    
-    NIC(const std::string& interface);
-    ~NIC();
+
+    NIC_Base();
+    explicit NIC_Base(const BufferPool::Config& pool_config);
+    virtual ~NIC_Base() = default;
     
     void set_address(const Mac_Address& addr);
     const Mac_Address& get_address() const;
     
-    Buffer* alloc();
-    int send(Buffer* buf, bool internal);
+    Buffer* alloc();  // nullptr se o pool de buffers estiver esgotado
+    virtual int send(Buffer* buf, bool internal) = 0;
     void receive(const Frame* frame, size_t size, bool is_internal);
+
+    // Controle de envio em lote da Engine (apenas comunicação externa)
+    virtual void begin_batch() = 0;
+    virtual int end_batch() = 0;
+    virtual int flush() = 0;
+
     const Statistics& get_statistics() const;
+    BufferPool::Statistics get_buffer_statistics() const;
+    virtual InternalEngine::Statistics get_internal_statistics() const = 0;
     
     void free(Buffer* buf);
+
+    // Filtro de frames aplicado pela Engine (no kernel, quando suportado)
+    virtual SocketFilter default_filter() const = 0;
+    virtual bool set_filter(const SocketFilter& filter) = 0;
     
     void attach(Conditional_Data_Observer* obs);
     void detach(Conditional_Data_Observer* obs);
+
+protected:
+    Mac_Address mac_address;                  // Endereço MAC da interface
+    Statistics stats;                         // Estatísticas de tráfego
+    Conditional_Data_Observed observed;
+    BufferPool buffer_pool;                   // Memória dos Buffers de envio e recebimento
+};
+
+template <typename Engine>
+class NIC : public NIC_Base {
+public:
+    NIC(const std::string& interface);
+    NIC(const std::string& interface, const typename Engine::Config& config);
+    NIC(const std::string& interface, const typename Engine::Config& config, const BufferPool::Config& pool_config,
+        const InternalEngine::Config& internal_config = InternalEngine::Config());
+    ~NIC();
+    
+    int send(Buffer* buf, bool internal) override;
+
+    void begin_batch() override;
+    int end_batch() override;
+    int flush() override;
+
+    SocketFilter default_filter() const override;
+    bool set_filter(const SocketFilter& filter) override;
+
+    InternalEngine::Statistics get_internal_statistics() const override;
     
 private:
     std::unique_ptr<Engine> engine;           // Mecanismo de rede específico (depende do template)
     std::unique_ptr<InternalEngine> internal_engine; // Engine para comunicacão interna
-    Mac_Address mac_address;                  // Endereço MAC da interface
-    Statistics stats;                         // Estatísticas de tráfego
-    Conditional_Data_Observed observed;
 };
@@ -2,12 +2,17 @@
 
 #include <list>
 #include <mutex>
-#include <queue>
+#include <vector>
+#include <condition_variable>
+#include <cstdint>
+#include <chrono>
+#include <unordered_map>
 #include <semaphore.h>
 #include <array>
 
 #include "message.hpp"
 #include "ethernet.hpp"
+#include "read_mostly.hpp"
 
 // Forward declarations
 template<typename> class NIC;
@@ -16,34 +21,130 @@ class Protocol;
 using Protocol_Number = Ethernet::Protocol_Number;
 using Address = Ethernet::Address;
 
+// Observador de um componente: fila circular limitada de referências a mensagens.
+// A capacidade limita a memória (e os buffers da NIC) retidos por um componente
+// lento; a política de estouro decide o que acontece com a fila cheia. As posições
+// são alocadas sob demanda, dobrando até a capacidade.
 class Concurrent_Observer {
 public:
+    // O que update() faz quando a fila está cheia
+    enum class Overflow {
+        // O produtor espera espaço (até close()). Cuidado: os produtores são threads
+        // compartilhadas — a thread do Reactor (todas as NICs do processo), a thread
+        // da InternalEngine, as threads do PeriodicScheduler e, na entrega interna
+        // direta, a thread do componente que envia. Uma fila BLOCK cheia para todas
+        // as entregas dessas threads; use só com consumidores que sempre esvaziam a
+        // fila. Se o produtor é o próprio consumidor (um componente que envia para si
+        // mesmo com a fila cheia), a espera nunca terminaria: a mensagem é descartada.
+        BLOCK,
+        DROP_OLDEST,    // Descarta a mensagem mais antiga da fila e enfileira a nova
+        DROP_NEWEST     // Descarta a mensagem nova
+    };
+
+    // Configuração da fila
+    struct Config {
+        // Bem abaixo do pool de buffers da NIC (1024 por padrão): um componente lento
+        // retém no máximo 'capacity' buffers (e só enquanto o pool não está baixo).
+        size_t capacity = 128;
+        Overflow overflow = Overflow::DROP_OLDEST;
+        // Conflação: uma mensagem nova substitui, na mesma posição, a pendente com a
+        // mesma origem e o mesmo tipo (só o valor mais recente é entregue).
+        bool conflate = false;
+        std::vector<Ethernet::Type> conflate_types;  // Se não vazio, conflaciona apenas esses tipos
+    };
+
+    // Contadores da fila
+    struct Statistics {
+        uint64_t messages_queued = 0;        // Mensagens enfileiradas
+        uint64_t messages_dropped = 0;       // Mensagens novas recusadas com a fila cheia (DROP_NEWEST, envio para si com BLOCK ou após close())
+        uint64_t messages_overwritten = 0;   // Mensagens antigas descartadas com a fila cheia (DROP_OLDEST)
+        uint64_t producer_waits = 0;         // Vezes que um produtor esperou espaço (BLOCK)
+        uint64_t messages_conflated = 0;     // Mensagens pendentes substituídas por uma mais recente
+        size_t high_water = 0;               // Maior ocupação da fila
+        size_t capacity = 0;
+    };
+
     Address communicator_address;
 
     // Construtor
     Concurrent_Observer();
+    explicit Concurrent_Observer(const Config& config);
+    virtual ~Concurrent_Observer();
+
+    Concurrent_Observer(const Concurrent_Observer&) = delete;
+    Concurrent_Observer& operator=(const Concurrent_Observer&) = delete;
 
-    void update(Message message);
-    Message updated();
+    // Enfileira uma referência à mensagem (os dados não são copiados). Pode ser
+    // redefinido por observadores que tratam a mensagem sem fila (AsyncCommunicator).
+    virtual void update(const MessageRef& message);
+    MessageRef updated();
+
+    // Espera uma mensagem até 'deadline' (relógio monotônico); retorna false se nenhuma chegou
+    bool updated_until(MessageRef* message, std::chrono::steady_clock::time_point deadline);
+
+    // Espera a primeira mensagem até 'deadline' e retira, com um único lock, até 'max'
+    // mensagens já enfileiradas; retorna quantas foram retiradas (0 se o prazo venceu)
+    size_t updated_many(MessageRef* messages, size_t max, std::chrono::steady_clock::time_point deadline);
 
     // Retorna se a mensagens na fila.
     bool hasMessage();
 
+    // Deixa de aceitar mensagens e libera os produtores bloqueados (usado antes do detach).
+    void close();
+
+    Statistics statistics();
+
 private:
+    // Chave de conflação: origem (veículo e componente) e tipo
+    struct Key {
+        Ethernet::Mac_Address vehicle_id;
+        Ethernet::Thread_ID component_id;
+        Ethernet::Type type;
+
+        bool operator==(const Key& other) const {
+            return vehicle_id == other.vehicle_id && component_id == other.component_id && type == other.type;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    void grow();
+    MessageRef pop();
+    bool wait_until(std::chrono::steady_clock::time_point deadline);
+    bool conflates(const MessageRef& message) const;
+    static Key key_of(const MessageRef& message);
+    MessageRef& slot(uint64_t sequence) { return _message_buffer[sequence % _message_buffer.size()]; }
+    void forget(uint64_t sequence);
+
+    Config _config;
     sem_t semaphore;
-    std::queue<Message> _message_buffer;
+    std::vector<MessageRef> _message_buffer;   // Fila circular; cresce sob demanda até _config.capacity
+    uint64_t first = 0;                        // Número de sequência da mensagem mais antiga
+    size_t count = 0;                          // Mensagens na fila
+    std::unordered_map<Key, uint64_t, KeyHash> pending;  // Chave -> sequência da mensagem pendente (conflação)
+    bool closed = false;
     std::mutex mutex;
+    std::condition_variable space;             // Sinaliza espaço livre aos produtores (BLOCK)
+    size_t producers_waiting = 0;
+    Statistics stats;
 };
 
+// Observadores indexados pelo id do componente. O notify lê o índice sem locks
+// e nunca espera por attach/detach, que publicam uma nova cópia; o detach só
+// retorna quando nenhum notify usa mais a cópia antiga, de modo que o
+// observador removido não recebe mais mensagens.
 class Concurrent_Observed {
 public:
+    typedef std::unordered_map<Ethernet::Thread_ID, Concurrent_Observer*> Index;
+
     void attach(Concurrent_Observer* observer);
     void detach(Concurrent_Observer* observer);
-    void notify(Message message);
+    void notify(const MessageRef& message);
 
 private:
-    std::list<Concurrent_Observer*> observers;
-    std::mutex mutex;
+    ReadMostly<Index> observers;
 };
 
 class Conditional_Data_Observer {
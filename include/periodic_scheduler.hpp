@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Runs periodic tasks on a small fixed pool of threads.
+// Every task sits in a min-heap keyed by its next release time; the pool
+// threads sleep until the earliest release and then run every task that is
+// due, one per thread at a time. Tasks released at the same instant run in
+// EDF order (earliest absolute deadline, i.e. shortest period, first). A task
+// is released again one period after its previous release, not after it ran,
+// so its stream does not drift; releases missed because the task ran late are
+// skipped and counted as deadline misses instead of being fired in a burst.
+class PeriodicScheduler {
+public:
+    typedef uint64_t Handle;
+    typedef std::function<void()> Task;
+    typedef std::chrono::steady_clock Clock;
+
+    // Counters of one task
+    struct Statistics {
+        Handle handle = 0;
+        std::chrono::microseconds period{0};
+        uint64_t releases = 0;                     // Times the task ran
+        uint64_t deadline_misses = 0;              // Releases that ran after their deadline or were skipped
+        std::chrono::microseconds max_jitter{0};   // Largest delay between a release and its run
+        std::chrono::microseconds mean_jitter{0};
+    };
+
+    // 'threads' pool threads are started with the first task
+    explicit PeriodicScheduler(unsigned int threads = 2);
+    ~PeriodicScheduler();
+
+    PeriodicScheduler(const PeriodicScheduler&) = delete;
+    PeriodicScheduler& operator=(const PeriodicScheduler&) = delete;
+
+    // Schedules 'task' every 'period', first released one period from now
+    Handle add(std::chrono::microseconds period, Task task);
+
+    // Cancels a task; once it returns the task is not running and will not run
+    // again (unless called from the task itself). Returns false for an unknown handle.
+    // 'final_stats', if given, receives the counters of the task as it was removed.
+    bool remove(Handle handle, Statistics* final_stats = nullptr);
+
+    // Counters of the tasks still scheduled
+    std::vector<Statistics> statistics() const;
+
+    // Number of tasks still scheduled
+    size_t size() const;
+
+private:
+    struct Entry {
+        Handle handle;
+        Clock::duration period;
+        Task task;
+        bool active = true;
+        std::thread::id running;           // Pool thread running the task, if any
+        uint64_t releases = 0;
+        uint64_t deadline_misses = 0;
+        Clock::duration max_jitter{0};
+        Clock::duration total_jitter{0};
+    };
+
+    // One pending release of an entry; the heap holds one per active entry
+    struct Release {
+        Clock::time_point time;
+        Clock::time_point deadline;
+        std::shared_ptr<Entry> entry;
+
+        bool operator>(const Release& other) const {
+            return time != other.time ? time > other.time : deadline > other.deadline;
+        }
+    };
+
+    void run();
+
+    static Statistics snapshot(const Entry& entry);
+
+    unsigned int thread_count;
+    std::vector<std::thread> threads;
+    std::priority_queue<Release, std::vector<Release>, std::greater<Release>> releases;
+    std::unordered_map<Handle, std::shared_ptr<Entry>> entries;
+    Handle next_handle = 1;
+    bool stopping = false;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;       // New earliest release or shutdown
+    std::condition_variable finished;   // A task finished running
+};
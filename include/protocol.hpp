@@ -22,11 +22,11 @@ class DataPublisher;
 
 class Protocol {
 public:
-    typedef NIC<Engine>::Buffer Buffer;
+    typedef NIC_Base::Buffer Buffer;
 
     Protocol_Number protocol_number;
 
-    Protocol(NIC<Engine>* nic, DataPublisher* data_publisher, Protocol_Number protocol_number,
+    Protocol(NIC_Base* nic, DataPublisher* data_publisher, Protocol_Number protocol_number,
             RSUHandler* rsu_handler = nullptr, TimeSyncManager* tsm = nullptr);
     ~Protocol();
 
@@ -36,15 +36,21 @@ public:
     void attach(Concurrent_Observer* obs);
     void detach(Concurrent_Observer* obs);
 
+    void set_internal_fast_path(bool enabled);
+
+    // Agrupa os envios externos feitos até end_batch() em um único lote da NIC.
+    void begin_batch();
+    int end_batch();
+
 private: 
-    void processInternalSend(Ethernet::InternalPayload* payload, Ethernet::Thread_ID src_component, Ethernet::Thread_ID dst_component, Type type, Period period);
-    void processExternalSend(Ethernet::ExternalPayload* payload, Address from, Address to, Type type, Period period, Quadrant_ID group_id, MAC_key mac);
+    void processInternalSend(Ethernet::InternalHeader* header, Ethernet::Thread_ID src_component, Ethernet::Thread_ID dst_component, Type type, Period period, unsigned int size);
+    void processExternalSend(Ethernet::ExternalHeader* header, Address from, Address to, Type type, Period period, Quadrant_ID group_id, MAC_key mac, unsigned int size);
 
-    void processInternalReceive(Ethernet::InternalPayload payload);
-    void processExternalReceive(Ethernet::ExternalPayload payload);
+    void processInternalReceive(Buffer* buffer, const Ethernet::InternalHeader& header, const uint8_t* data);
+    void processExternalReceive(Buffer* buffer, const Ethernet::ExternalHeader& header, const uint8_t* data);
 
 private:
-    NIC<Engine>* _nic;
+    NIC_Base* _nic;
 
     DataPublisher* _data_publisher;
     TimeSyncManager* _time_sync_manager;
@@ -52,4 +58,7 @@ private:
 
     Conditional_Data_Observer _data_observer;
     Concurrent_Observed _observed;
+
+    // Mensagens internas entregues diretamente na thread do remetente
+    bool _internal_fast_path = true;
 };
\ No newline at end of file
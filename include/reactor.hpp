@@ -0,0 +1,60 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <cstdint>
+
+// Process-wide epoll reactor shared by every Engine.
+// Each registered descriptor is armed with EPOLLONESHOT, so a handler never
+// runs on two threads at once and frames of one socket keep their order,
+// while different sockets are served in parallel by the reactor threads.
+// The reactor lives until the process exits; its threads are detached.
+class Reactor {
+public:
+    using Handler = std::function<void()>;
+
+    // Returns the reactor of the current process
+    static Reactor& instance();
+
+    // Sets the number of receive threads (threads already running are kept)
+    static void set_thread_count(unsigned int count);
+
+    // Raises the number of receive threads to at least 'count'
+    static void reserve_threads(unsigned int count);
+
+    // Registers a readable descriptor, returning the id used to remove it
+    uint64_t add(int fd, Handler handler);
+
+    // Removes a descriptor, waiting for a handler running on another thread to return
+    void remove(uint64_t id);
+
+private:
+    struct Registration {
+        int fd;
+        Handler handler;
+        bool busy = false;
+    };
+
+    Reactor();
+
+    void start_locked();
+    void loop();
+
+    // Fork handlers: the child inherits neither the threads nor the registrations
+    static void before_fork();
+    static void after_fork_parent();
+    static void after_fork_child();
+
+    int _epoll_fd = -1;
+    std::unordered_map<uint64_t, std::shared_ptr<Registration>> registrations;
+    uint64_t next_id = 1;
+
+    unsigned int thread_count = 1;
+    unsigned int running_threads = 0;
+
+    std::mutex mutex;
+    std::condition_variable idle_cv;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// Value read on every message and changed rarely (RCU style).
+// Readers take no lock: they count themselves in the counter of the current
+// epoch while they hold a Reader. Writers are serialised by a mutex, publish
+// a new copy of the value and wait until the readers that may still see the
+// old copy are gone (two epoch flips, as in SRCU) before deleting it. Once
+// store() or update() returns, no reader sees the previous value any more.
+template <typename T>
+class ReadMostly {
+public:
+    // Read access to the value published when the Reader was created
+    class Reader {
+    public:
+        explicit Reader(const ReadMostly& owner)
+            : counter(&owner.readers[owner.epoch.load(std::memory_order_seq_cst) & 1]) {
+            counter->fetch_add(1, std::memory_order_seq_cst);
+            value = owner.value.load(std::memory_order_seq_cst);
+        }
+
+        ~Reader() {
+            counter->fetch_sub(1, std::memory_order_release);
+        }
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        const T& operator*() const { return *value; }
+        const T* operator->() const { return value; }
+
+    private:
+        std::atomic<unsigned int>* counter;
+        const T* value;
+    };
+
+    ReadMostly() : value(new T()) {}
+
+    ~ReadMostly() {
+        delete value.load();
+    }
+
+    ReadMostly(const ReadMostly&) = delete;
+    ReadMostly& operator=(const ReadMostly&) = delete;
+
+    Reader read() const {
+        return Reader(*this);
+    }
+
+    // Replaces the value
+    void store(T new_value) {
+        std::lock_guard<std::mutex> lock(writer);
+        publish(new T(std::move(new_value)));
+    }
+
+    // Applies 'change' to a copy of the value and publishes the copy
+    template <typename Change>
+    void update(Change change) {
+        std::lock_guard<std::mutex> lock(writer);
+        T* copy = new T(*value.load(std::memory_order_relaxed));
+        change(*copy);
+        publish(copy);
+    }
+
+private:
+    // Publishes 'new_value' and deletes the old value after the grace period (writer lock held)
+    void publish(T* new_value) {
+        T* old_value = value.exchange(new_value, std::memory_order_seq_cst);
+        for (int flip = 0; flip < 2; ++flip) {
+            unsigned int previous = epoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+            while (readers[previous].load(std::memory_order_acquire) != 0) {
+                std::this_thread::yield();
+            }
+        }
+        delete old_value;
+    }
+
+    std::atomic<T*> value;
+    std::atomic<unsigned int> epoch{0};
+    mutable std::atomic<unsigned int> readers[2] = {{0}, {0}};
+    std::mutex writer;
+};
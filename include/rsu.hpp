@@ -7,6 +7,8 @@
 #include <cstdint>
 #include <string>
 #include <array>
+#include <memory>
+#include <vector>
 #include <sstream>
 #include <iomanip>
 
@@ -25,8 +27,12 @@ class RSU {
         };
         
         // Construtor.
-        RSU(const std::string& interface, Ethernet::Quadrant_ID groupId, Ethernet::Quadrant quadt) : nic(interface), 
-                protocol(&nic, &data_publisher, 0x88B5), group_id(groupId), quadrant(quadt), running(true) {
+        RSU(const std::string& interface, Ethernet::Quadrant_ID groupId, Ethernet::Quadrant quadt)
+            : RSU(std::make_unique<NIC<Engine>>(interface), groupId, quadt) {}
+
+        // Construtor com uma NIC já criada (ex.: NIC<SimEngine>).
+        RSU(std::unique_ptr<NIC_Base> nic_, Ethernet::Quadrant_ID groupId, Ethernet::Quadrant quadt) : nic(std::move(nic_)), 
+                protocol(nic.get(), &data_publisher, 0x88B5), group_id(groupId), quadrant(quadt), running(true) {
             
             // Inicializa o MAC do grupo.
             mac = generate_group_key();
@@ -95,7 +101,7 @@ class RSU {
             ThreadData* data = static_cast<ThreadData*>(arg);
             RSU* self = data->instance;
 
-            self->communicator = new Communicator(&self->protocol, self->nic.get_address(), pthread_self());
+            self->communicator = new Communicator(&self->protocol, self->nic->get_address(), pthread_self());
             // Sinaliza que o communicator foi inicializado
             {
                 std::lock_guard<std::mutex> lock(self->mutex);
@@ -104,37 +110,49 @@ class RSU {
             self->cv.notify_all(); // Acorda thread principal para continuar
             self->data_publisher.subscribe(self->communicator->getObserver(), &self->types);
 
+            // Responde JOIN_REQ e DELAY_REQ.
+            auto responder = [self](Message& message) {
+                switch (message.getType()) {
+                    case Ethernet::TYPE_RSU_JOIN_REQ:
+                        // Responde veiculo com ID, MAC e Quadrante do grupo (RSU).
+                        //std::cout << "RSU " << (int)self->group_id << " recebeu JOIN_REQ" << std::endl;
+                        message.setType(Ethernet::TYPE_RSU_JOIN_RESP);
+                        message.setDstAddress(message.getSrcAddress());
+                        message.setGroupID(self->group_id);
+                        message.setMAC(self->mac);
+                        message.setPeriod(0);
+                        message.setData(reinterpret_cast<Ethernet::Quadrant*>(&self->quadrant), sizeof(Ethernet::Quadrant));
+                        //std::cout << "RSU " << (int)self->group_id << " enviou JOIN_RESP" << std::endl;
+                        self->communicator->send(&message);
+                        break;
+                    case Ethernet::TYPE_PTP_DELAY_REQ:
+                        // Responde veiculo com DELAY RESP.
+                        //std::cout << "RSU " << (int)self->group_id << " recebeu DELAY_REQ" << std::endl;
+                        message.setType(Ethernet::TYPE_PTP_DELAY_RESP);
+                        message.setDstAddress(message.getSrcAddress());
+                        message.setPeriod(0);
+                        //std::cout << "RSU " << (int)self->group_id << " enviou DELAY_RESP" << std::endl;
+                        self->communicator->send(&message);
+                        break;
+                    default:
+                        break;
+                }
+            };
+
+            std::vector<Message> messages(32);
             while (self->running) {
-                //std::cout << "RSU aguardando mensagens..." << std::endl;
-                if (self->communicator->hasMessage()) {
-                    Message message;
-                    self->communicator->receive(&message);
-                    switch (message.getType()) {
-                        case Ethernet::TYPE_RSU_JOIN_REQ:
-                            // Responde veiculo com ID, MAC e Quadrante do grupo (RSU).
-                            //std::cout << "RSU " << (int)self->group_id << " recebeu JOIN_REQ" << std::endl;
-                            message.setType(Ethernet::TYPE_RSU_JOIN_RESP);
-                            message.setDstAddress(message.getSrcAddress());
-                            message.setGroupID(self->group_id);
-                            message.setMAC(self->mac);
-                            message.setPeriod(0);
-                            message.setData(reinterpret_cast<Ethernet::Quadrant*>(&self->quadrant), sizeof(Ethernet::Quadrant));
-                            //std::cout << "RSU " << (int)self->group_id << " enviou JOIN_RESP" << std::endl;
-                            self->communicator->send(&message);
-                            break;
-                        case Ethernet::TYPE_PTP_DELAY_REQ:
-                            // Responde veiculo com DELAY RESP.
-                            //std::cout << "RSU " << (int)self->group_id << " recebeu DELAY_REQ" << std::endl;
-                            message.setType(Ethernet::TYPE_PTP_DELAY_RESP);
-                            message.setDstAddress(message.getSrcAddress());
-                            message.setPeriod(0);
-                            //std::cout << "RSU " << (int)self->group_id << " enviou DELAY_RESP" << std::endl;
-                            self->communicator->send(&message);
-                            break;
-                        default:
-                            break;
-                    }
+                // Dorme até chegar uma mensagem (o prazo só serve para perceber o encerramento)
+                // e retira de uma vez as que já estiverem na fila.
+                size_t received = self->communicator->receive_many(messages.data(), messages.size(), std::chrono::milliseconds(100));
+                if (received == 0) {
+                    continue;
+                }
+                // Responde a todas as mensagens do lote em um unico lote de envio.
+                self->nic->begin_batch();
+                for (size_t i = 0; i < received; i++) {
+                    responder(messages[i]);
                 }
+                self->nic->end_batch();
             }
             self->data_publisher.unsubscribe(self->communicator->getObserver());
             pthread_exit(nullptr);
@@ -175,7 +193,7 @@ class RSU {
         }
 
     private:
-        NIC<Engine> nic;            
+        std::unique_ptr<NIC_Base> nic;
         Protocol protocol;     
         DataPublisher data_publisher;
         Communicator* communicator;
@@ -117,7 +117,11 @@ class RSUHandler {
             ThreadData* data = static_cast<ThreadData*>(arg);
             RSUHandler* self = data->instance;
 
-            Communicator communicator(self->protocol, self->address.vehicle_id, pthread_self());
+            // Só a posição mais recente do GPS interessa: posições pendentes são substituídas.
+            Concurrent_Observer::Config queue_config;
+            queue_config.conflate = true;
+            queue_config.conflate_types.push_back(Ethernet::TYPE_POSITION_DATA);
+            Communicator communicator(self->protocol, self->address.vehicle_id, pthread_self(), queue_config);
             self->data_publisher->subscribe(communicator.getObserver(), &self->types);
 
             Ethernet::Position position;
@@ -135,9 +139,9 @@ class RSUHandler {
                     self->last_gps_data_send_time = std::chrono::steady_clock::now();
                 }
 
-                if (communicator.hasMessage()) {
-                    Message message;
-                    communicator.receive(&message);
+                // Dorme até chegar uma mensagem ou até o próximo envio de interesse no GPS.
+                Message message;
+                if (communicator.receive_until(&message, self->last_gps_data_send_time + self->gps_data_interval)) {
                     if (message.getType() == Ethernet::TYPE_POSITION_DATA && !first_position_received) {
                         first_position_received = true;
                     }
@@ -168,8 +172,8 @@ class RSUHandler {
                                 // Se o veículo se afastou do quadrante do grupo vizinho, remove dos vizinhos.
                                 if (!near_quadrant) {
                                     self->neighbor_groups.erase(group_id); // Remove grupo da estrutura de grupos vizinhos.
-                                    // Remove threads periodicas do DataPublisher destinadas ao antigo grupo vizinho.
-                                    self->data_publisher->delete_group_threads(self->group_id);
+                                    // Remove publicações periodicas do DataPublisher destinadas ao antigo grupo vizinho.
+                                    self->data_publisher->delete_group_threads(group_id);
                                 }
                                 // Se o veículo entrou no quadrante, envia JOIN_REQ e remove dos vizinhos.
                                 else if (in_quadrant) {
@@ -232,7 +236,7 @@ class RSUHandler {
                                 if (!self->has_group) {
                                     self->has_group = true;
                                 } else {
-                                    // Remove threads periodicas do DataPublisher destinadas ao grupo antigo.
+                                    // Remove publicações periodicas do DataPublisher destinadas ao grupo antigo.
                                     self->data_publisher->delete_group_threads(self->group_id);
                                 }
                                 // Atualiza novo grupo do veiculo.
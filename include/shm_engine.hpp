@@ -0,0 +1,95 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+#include "socket_filter.hpp"
+
+// Shared memory engine, an alternative to Engine for NIC<ShmEngine>.
+// The interface name selects a broadcast ring in POSIX shared memory
+// (shm_open) mapped by every participating process of the host. Senders
+// claim slots with an atomic ticket and publish them with a per-slot
+// sequence number (seqlock), so any number of processes and threads may
+// send at once; each receiving engine reads the ring with its own cursor
+// and sleeps on a shared futex when it is empty. A reader that falls more
+// than a ring behind skips ahead and counts the frames it lost.
+// Frames never cross the kernel network stack and a sender never receives
+// its own frames.
+class ShmEngine {
+public:
+    using Callback = std::function<void(const void*, size_t)>;
+
+    // Engine configuration (the ring geometry is fixed by the process that creates it)
+    struct Config {
+        unsigned int slot_count = 4096;      // Frames kept in the ring, power of two
+        unsigned int slot_size = 1536;       // Maximum frame size
+        uint16_t protocol_filter = 0x88B5;   // EtherType accepted by the receive filter (0 accepts any)
+    };
+
+    // Counters of this engine
+    struct Statistics {
+        uint64_t frames_sent = 0;
+        uint64_t frames_received = 0;    // Frames read from the ring (before filtering)
+        uint64_t frames_overrun = 0;     // Frames overwritten before this reader got to them
+    };
+
+    ShmEngine(const std::string& interface, Callback callback = nullptr, bool enable_receive = false);
+    ShmEngine(const std::string& interface, Callback callback, bool enable_receive, const Config& config);
+
+    ~ShmEngine();
+
+    int send(const void* data, size_t size);
+
+    // Every frame is visible to the readers as soon as it is sent, so
+    // batching only exists to keep the engine interface.
+    void begin_batch();
+    int end_batch();
+    int flush();
+
+    // Receive filter, evaluated by the reader thread before the callback
+    SocketFilter default_filter() const;
+    bool set_filter(const SocketFilter& filter);
+
+    Statistics statistics() const;
+
+    // Removes the shared memory object of a ring (processes that mapped it keep their mapping)
+    static bool unlink(const std::string& interface);
+
+private:
+    struct RingHeader;
+    struct Slot;
+
+    std::string _interface;
+    Callback _callback;
+    Config _config;
+    uint64_t _id = 0;                 // Marks the frames of this engine (pid and a local counter)
+
+    RingHeader* header = nullptr;
+    uint8_t* slots = nullptr;
+    size_t map_size = 0;
+    size_t slot_stride = 0;
+
+    // Receive state
+    uint64_t cursor = 0;              // Next ticket to read (reader thread only)
+    std::thread reader_thread;
+    std::atomic<bool> running{false};
+
+    SocketFilter filter;
+    std::mutex filter_mutex;
+
+    std::atomic<uint64_t> frames_sent{0};
+    std::atomic<uint64_t> frames_received{0};
+    std::atomic<uint64_t> frames_overrun{0};
+
+    static std::string object_name(const std::string& interface);
+    bool map_ring(const std::string& name);
+    Slot* slot(uint64_t ticket) const;
+
+    // Reader thread: follows the ring and sleeps on the futex when it is empty
+    void receive_loop();
+    bool receive_pending();
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+#include "socket_filter.hpp"
+
+// Simulated engine, an alternative to Engine for NIC<SimEngine>.
+// The interface name selects an in-memory broadcast bus shared by every
+// SimEngine of the process that uses the same name; no socket, interface or
+// privilege is needed. Each bus has one delivery thread that hands frames to
+// every other receiving engine once their delivery time is reached, applying
+// the latency, jitter, loss and bandwidth of the medium. Frames of one sender
+// are delivered in order and a sender never receives its own frames.
+class SimEngine {
+public:
+    using Callback = std::function<void(const void*, size_t)>;
+
+    // Engine configuration. The medium fields (latency to bandwidth) belong to
+    // the bus: they are taken from the first engine that opens it, unless
+    // set_medium() was called for that bus, and are shared by all its engines.
+    struct Config {
+        unsigned int latency_us = 0;         // Propagation delay added to every frame
+        unsigned int jitter_us = 0;          // Extra delay drawn uniformly from [0, jitter_us]
+        double loss = 0.0;                   // Probability that a given receiver misses a frame
+        uint64_t bandwidth_bps = 0;          // Bit rate shared by every sender of the bus (0 = unlimited)
+        uint16_t protocol_filter = 0x88B5;   // EtherType accepted by the receive filter (0 accepts any)
+    };
+
+    // Counters of one bus
+    struct Statistics {
+        uint64_t frames_sent = 0;        // Frames handed to the bus
+        uint64_t frames_delivered = 0;   // Copies delivered to receivers
+        uint64_t frames_lost = 0;        // Copies dropped by the loss model
+        uint64_t frames_filtered = 0;    // Copies rejected by a receiver filter
+    };
+
+    SimEngine(const std::string& interface, Callback callback = nullptr, bool enable_receive = false);
+    SimEngine(const std::string& interface, Callback callback, bool enable_receive, const Config& config);
+
+    ~SimEngine();
+
+    int send(const void* data, size_t size);
+
+    // The bus queues every frame as soon as it is sent, so batching only
+    // exists to keep the engine interface; flush() never has work to do.
+    void begin_batch();
+    int end_batch();
+    int flush();
+
+    // Receive filter, evaluated by the delivery thread before the callback
+    SocketFilter default_filter() const;
+    bool set_filter(const SocketFilter& filter);
+
+    // Sets the medium of a bus (applies at once if the bus already exists)
+    static void set_medium(const std::string& interface, const Config& config);
+
+    // Returns the counters of a bus (zero if it does not exist)
+    static Statistics statistics(const std::string& interface);
+
+private:
+    class Bus;
+    friend class Bus;
+
+    std::string _interface;
+    Callback _callback;
+    Config _config;
+    uint64_t _id = 0;                    // Identifies the sender of each frame in the bus
+    bool _receive = false;
+    std::shared_ptr<Bus> bus;
+
+    // Receive filter (read by the delivery thread)
+    SocketFilter filter;
+    std::mutex filter_mutex;
+
+    // Delivery time of the last frame sent, keeping this sender in order under jitter
+    std::chrono::steady_clock::time_point last_due {};
+
+    // Called by the bus for every frame reaching this engine; false if the filter rejected it
+    bool deliver(const uint8_t* frame, size_t size);
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <initializer_list>
+
+// Builder for a classic BPF program attached with SO_ATTACH_FILTER.
+// Rules are evaluated in the order they were added; a frame is accepted only
+// if every rule passes. Offsets are relative to the start of the Ethernet
+// frame and values are compared byte by byte, exactly as they appear on the wire.
+class SocketFilter {
+public:
+    using Bytes = std::vector<uint8_t>;
+
+    // Accepts only frames whose destination MAC is broadcast
+    SocketFilter& accept_broadcast();
+
+    // Accepts only frames carrying the given EtherType
+    SocketFilter& accept_protocol(uint16_t protocol);
+
+    // Drops frames sent from this host (PACKET_OUTGOING)
+    SocketFilter& drop_outgoing();
+
+    // Drops frames whose source MAC is the given address
+    SocketFilter& drop_source(const uint8_t* mac);
+
+    // Accepts only frames whose bytes at 'offset' equal one of 'values'
+    SocketFilter& require(uint32_t offset, std::initializer_list<Bytes> values);
+    SocketFilter& require(uint32_t offset, const std::vector<Bytes>& values);
+
+    // Drops frames whose bytes at 'offset' equal 'value'
+    SocketFilter& exclude(uint32_t offset, const Bytes& value);
+
+    // Evaluates the rules in user space (pkttype as in sockaddr_ll)
+    bool matches(const uint8_t* frame, size_t size, int pkttype = 0) const;
+
+    // Compiles the rules and attaches the program to the socket
+    bool attach(int socket) const;
+
+    // Helper to view any trivially copyable value as raw bytes
+    template <typename T>
+    static Bytes bytes(const T& value) {
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(&value);
+        return Bytes(data, data + sizeof(T));
+    }
+
+private:
+    struct Rule {
+        uint32_t offset;            // Offset in the frame (or ancillary load offset)
+        std::vector<Bytes> values;  // Alternatives compared at the offset
+        bool exclude;               // true: drop on match, false: drop on mismatch
+    };
+
+    std::vector<Rule> rules;
+};
@@ -79,62 +79,61 @@ private:
         self->dataPublisher->subscribe(communicator.getObserver(), &self->types);
 
         while (true) {
-            if (communicator.hasMessage()) {
-                Message message;
-                communicator.receive(&message);
-                switch (message.getType()) {
-                    case Ethernet::TYPE_PTP_SYNC:
-                        // Verifica se o remetente é o Grandmaster
-                        if (message.getGroupID() == self->grandmasterGroupId) {
-                            //std::cout << "⏱️  Sincronizando tempo com a RSU " << (int)self->grandmasterGroupId << std::endl;
-                            self->syncSendTime = message.getTimestamp();
-                            self->syncRecvTime = self->now();
-
-                            // Envia mensagem de Delay Request para o Grandmaster.
-                            message.setType(Ethernet::TYPE_PTP_DELAY_REQ);
-                            message.setDstAddress(self->grandmasterAddress);
-                            message.setPeriod(0);
-                            communicator.send(&message);
-
-                            self->delayReqSendTime = message.getTimestamp();
-                        }
-                        break;
-                    case Ethernet::TYPE_PTP_DELAY_RESP:
-                    {
-                        //std::cout << "Delay RESP recebido" << std::endl;
-                        self->delayRespRecvTime = message.getTimestamp();
-                        // Cálculo do offset baseado nas fórmulas do PTP
-                        // t1: syncSendTime (GM)       t2: syncRecvTime (Slave)
-                        // t3: delayReqSendTime (Slave) t4: delayRespRecvTime (GM)
-                        
-                        auto t1 = self->syncSendTime;
-                        auto t2 = self->syncRecvTime;
-                        auto t3 = self->delayReqSendTime;
-                        auto t4 = self->delayRespRecvTime;
-
-                        // Calcula offset e delay corretamente
-                        //auto offset = std::chrono::duration_cast<std::chrono::microseconds>(((t2 - t1) - (t4 - t3)) / 2);
-                        //auto delay  = std::chrono::duration_cast<std::chrono::microseconds>((t2 - t1 + (t4 - t3)) / 2);
-
-                        // Atualiza o clockOffset com o novo offset calculado
-                        self->clockOffset = std::chrono::duration_cast<std::chrono::microseconds>(((t2 - t1) - (t4 - t3)) / 2);
-
-                        /*
-                        std::cout << "\n(S) Offset ajustado: " << self->clockOffset.count() << " µs (";
-                        self->print_address(self->address.vehicle_id);
-                        std::cout << ")" << std::endl;
-                        */
-
-                        //std::cout << "Delay: " << delay.count() << " µs" << std::endl;
-                        //std::cout << "syncRecvTime: " << std::chrono::duration_cast<std::chrono::microseconds>(syncRecvTime.time_since_epoch()).count() << " µs" << std::endl;
-                        //std::cout << "syncSendTime: " << std::chrono::duration_cast<std::chrono::microseconds>(syncSendTime.time_since_epoch()).count() << " µs" << std::endl;
-                        //std::cout << "delayRespRecvTime: " << std::chrono::duration_cast<std::chrono::microseconds>(delayRespRecvTime.time_since_epoch()).count() << " µs" << std::endl;
-                        //std::cout << "delayReqSendTime: " << std::chrono::duration_cast<std::chrono::microseconds>(delayReqSendTime.time_since_epoch()).count() << " µs\n" << std::endl;
-                        break;
+            // Bloqueia até a próxima mensagem PTP (sem consultar a fila em laço).
+            Message message;
+            communicator.receive(&message);
+            switch (message.getType()) {
+                case Ethernet::TYPE_PTP_SYNC:
+                    // Verifica se o remetente é o Grandmaster
+                    if (message.getGroupID() == self->grandmasterGroupId) {
+                        //std::cout << "⏱️  Sincronizando tempo com a RSU " << (int)self->grandmasterGroupId << std::endl;
+                        self->syncSendTime = message.getTimestamp();
+                        self->syncRecvTime = self->now();
+
+                        // Envia mensagem de Delay Request para o Grandmaster.
+                        message.setType(Ethernet::TYPE_PTP_DELAY_REQ);
+                        message.setDstAddress(self->grandmasterAddress);
+                        message.setPeriod(0);
+                        communicator.send(&message);
+
+                        self->delayReqSendTime = message.getTimestamp();
                     }
-                    default:
-                        break;
+                    break;
+                case Ethernet::TYPE_PTP_DELAY_RESP:
+                {
+                    //std::cout << "Delay RESP recebido" << std::endl;
+                    self->delayRespRecvTime = message.getTimestamp();
+                    // Cálculo do offset baseado nas fórmulas do PTP
+                    // t1: syncSendTime (GM)       t2: syncRecvTime (Slave)
+                    // t3: delayReqSendTime (Slave) t4: delayRespRecvTime (GM)
+                    
+                    auto t1 = self->syncSendTime;
+                    auto t2 = self->syncRecvTime;
+                    auto t3 = self->delayReqSendTime;
+                    auto t4 = self->delayRespRecvTime;
+
+                    // Calcula offset e delay corretamente
+                    //auto offset = std::chrono::duration_cast<std::chrono::microseconds>(((t2 - t1) - (t4 - t3)) / 2);
+                    //auto delay  = std::chrono::duration_cast<std::chrono::microseconds>((t2 - t1 + (t4 - t3)) / 2);
+
+                    // Atualiza o clockOffset com o novo offset calculado
+                    self->clockOffset = std::chrono::duration_cast<std::chrono::microseconds>(((t2 - t1) - (t4 - t3)) / 2);
+
+                    /*
+                    std::cout << "\n(S) Offset ajustado: " << self->clockOffset.count() << " µs (";
+                    self->print_address(self->address.vehicle_id);
+                    std::cout << ")" << std::endl;
+                    */
+
+                    //std::cout << "Delay: " << delay.count() << " µs" << std::endl;
+                    //std::cout << "syncRecvTime: " << std::chrono::duration_cast<std::chrono::microseconds>(syncRecvTime.time_since_epoch()).count() << " µs" << std::endl;
+                    //std::cout << "syncSendTime: " << std::chrono::duration_cast<std::chrono::microseconds>(syncSendTime.time_since_epoch()).count() << " µs" << std::endl;
+                    //std::cout << "delayRespRecvTime: " << std::chrono::duration_cast<std::chrono::microseconds>(delayRespRecvTime.time_since_epoch()).count() << " µs" << std::endl;
+                    //std::cout << "delayReqSendTime: " << std::chrono::duration_cast<std::chrono::microseconds>(delayReqSendTime.time_since_epoch()).count() << " µs\n" << std::endl;
+                    break;
                 }
+                default:
+                    break;
             }
         }
         self->dataPublisher->unsubscribe(communicator.getObserver());
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../include/communicator.hpp"
+#include "../include/async_communicator.hpp"
+#include "../include/executor.hpp"
 #include "../include/message.hpp"
 #include "../include/nic.hpp"
 #include "../include/protocol.hpp"
@@ -14,6 +16,8 @@
 #include <iostream>
 #include <unistd.h>
 #include <vector>
+#include <memory>
+#include <functional>
 
 // Classe que representa um veículo capaz de criar componentes que são executados em threads POSIX
 class Veiculo {
@@ -27,21 +31,35 @@ public:
     };
 
     // Construtor que inicializa o veículo, a NIC (placa de rede) e o protocolo de comunicação
-    Veiculo(const std::string& interface, const std::string& nome);
+    // 'threads_executor' é o número de threads que executam os componentes assíncronos
+    Veiculo(const std::string& interface, const std::string& nome, unsigned int threads_executor = 2);
 
-    // Destrutor que espera o término de todas as threads criadas antes de liberar os recursos
+    // Construtor com uma NIC já criada (ex.: NIC<SimEngine> para simular muitos veículos em um processo)
+    Veiculo(std::unique_ptr<NIC_Base> nic, const std::string& nome, unsigned int threads_executor = 2);
+
+    // Destrutor que espera o término de todas as threads criadas e dos componentes assíncronos
+    // antes de liberar os recursos
     ~Veiculo();
 
     // Tipo da função que representa a rotina da thread (função que será executada pela thread)
     using funcao = void* (*)(void*);
 
+    // Tipo da função que inicia um componente assíncrono (registra seus handlers no comunicador)
+    using funcao_assincrona = std::function<void(AsyncCommunicator&, const DadosComponente&)>;
+
     // Cria uma thread que representa um componente do veículo
     // Recebe o nome do componente e a função que a thread vai executar
     bool criar_componente(const std::string nome, funcao func_rotina);
 
+    // Cria um componente assíncrono, sem thread própria: seus handlers rodam no executor
+    // do veículo. 'fila' limita as mensagens que esperam pelos handlers do componente.
+    // Retorna o comunicador do componente, que pertence ao veículo.
+    AsyncCommunicator* criar_componente_assincrono(const std::string nome, funcao_assincrona iniciar,
+                                                   const Concurrent_Observer::Config& fila = Concurrent_Observer::Config());
+
 private:
     std::string nome;                   // Nome do veículo
-    NIC<Engine> nic;                    // Objeto que representa a interface de rede
+    std::unique_ptr<NIC_Base> nic;      // Objeto que representa a interface de rede
     Protocol protocolo;                 // Protocolo de comunicação baseado na NIC
 
     DataPublisher data_publisher;       // Publicador de dados
@@ -49,4 +67,7 @@ private:
     RSUHandler rsu_handler;             // Manipulador de RSU (Unidade de Rede Veicular)
 
     std::vector<pthread_t> threads;       // Vetor que armazena os IDs das threads criadas
+
+    Executor executor;                    // Threads compartilhadas pelos componentes assíncronos
+    std::vector<std::unique_ptr<AsyncCommunicator>> componentes_assincronos;
 };
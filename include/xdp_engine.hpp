@@ -0,0 +1,100 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <linux/if_xdp.h>
+
+#include "socket_filter.hpp"
+
+// AF_XDP engine, an alternative to Engine for NIC<XdpEngine>.
+// A single UMEM is shared by RX (first half of the frames, through the fill
+// ring) and TX (second half, recycled through the completion ring). An XDP
+// program redirects frames of the configured EtherType to the socket and
+// passes everything else to the kernel stack. Copy mode (the default) works
+// on any interface, including veth pairs.
+// Only one XdpEngine can receive on a given interface queue at a time.
+class XdpEngine {
+public:
+    using Callback = std::function<void(const void*, size_t)>;
+
+    // Engine configuration
+    struct Config {
+        unsigned int frame_count = 4096;     // UMEM frames, half for RX and half for TX
+        unsigned int frame_size = 2048;      // UMEM frame (chunk) size, power of two
+        unsigned int ring_size = 1024;       // Descriptors per ring, power of two
+        unsigned int queue_id = 0;           // Interface queue bound to the socket
+        bool zero_copy = false;              // XDP_ZEROCOPY (needs driver support) instead of XDP_COPY
+        uint16_t protocol = 0x88B5;          // EtherType redirected to the socket
+    };
+
+    XdpEngine(const std::string& interface, Callback callback = nullptr, bool enable_receive = false);
+    XdpEngine(const std::string& interface, Callback callback, bool enable_receive, const Config& config);
+
+    ~XdpEngine();
+
+    int send(const void* data, size_t size);
+
+    // Transmit batching: while a batch is open the TX ring is filled without
+    // waking the kernel, which is kicked once when the outermost batch closes.
+    void begin_batch();
+    int end_batch();
+    int flush();
+
+    // Received frames are matched against the filter in user space
+    // (the XDP program already drops other EtherTypes).
+    SocketFilter default_filter() const;
+    bool set_filter(const SocketFilter& filter);
+
+private:
+    // Ring shared with the kernel (producer/consumer indexes plus descriptors)
+    struct Ring {
+        uint32_t* producer = nullptr;
+        uint32_t* consumer = nullptr;
+        void* descs = nullptr;
+        uint32_t size = 0;
+        void* map = nullptr;
+        size_t map_size = 0;
+    };
+
+    std::string _interface;
+    Callback _callback;
+    Config _config;
+    int _ifindex = 0;
+    int _socket = -1;
+
+    // UMEM and rings
+    uint8_t* umem = nullptr;
+    size_t umem_size = 0;
+    Ring fill_ring;        // RX frames handed to the kernel
+    Ring completion_ring;  // TX frames returned by the kernel
+    Ring rx_ring;
+    Ring tx_ring;
+
+    // XDP program redirecting frames to the socket
+    int map_fd = -1;
+    int prog_fd = -1;
+    int link_fd = -1;
+    uint64_t _reactor_id = 0;
+
+    // Received frame filter (user space)
+    SocketFilter filter;
+    std::mutex filter_mutex;
+
+    // Transmit state
+    std::vector<uint64_t> tx_free;   // TX frames available for new sends
+    uint32_t tx_pending = 0;         // Descriptors written since the last kick
+    int tx_batch_depth = 0;
+    std::mutex tx_mutex;
+
+    bool map_ring(Ring& ring, const struct xdp_ring_offset& offset, uint64_t pgoff, size_t desc_size);
+    void unmap_ring(Ring& ring);
+    bool load_program();
+    void reclaim_completed();
+    int kick_locked();
+
+    // Reactor handler: delivers every frame available in the RX ring
+    void receive_ring();
+};
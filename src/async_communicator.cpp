@@ -0,0 +1,242 @@
+#include "../include/async_communicator.hpp"
+#include "../include/message.hpp"
+#include "../include/protocol.hpp"
+
+#include <algorithm>
+
+// Gera identificadores de componente ímpares: os pthread_t do glibc são endereços
+// alinhados (pares), de modo que não colidem com os componentes com thread própria.
+static Thread_ID next_component_id() {
+    static std::atomic<uint64_t> counter{0};
+    return static_cast<Thread_ID>((counter.fetch_add(1, std::memory_order_relaxed) << 1) | 1);
+}
+
+AsyncCommunicator::AsyncCommunicator(Protocol* protocol, Mac_Address vehicle_id, Executor* executor)
+    : AsyncCommunicator(protocol, vehicle_id, next_component_id(), executor) {}
+
+AsyncCommunicator::AsyncCommunicator(Protocol* protocol, Mac_Address vehicle_id, Executor* executor,
+                                     const Concurrent_Observer::Config& queue_config)
+    : AsyncCommunicator(protocol, vehicle_id, next_component_id(), executor, queue_config) {}
+
+AsyncCommunicator::AsyncCommunicator(Protocol* protocol, Mac_Address vehicle_id, Thread_ID component_id, Executor* executor,
+                                     const Concurrent_Observer::Config& queue_config)
+    : _protocol(protocol), _executor(executor), _config(queue_config), dispatcher(this)
+{
+    if (_config.capacity == 0) {
+        _config.capacity = 1;
+    }
+    stats.capacity = _config.capacity;
+
+    // Inicializa endereço do comunicador: identificador do veiculo (MAC da nic) e identificador do componente.
+    _address.vehicle_id = vehicle_id;
+    _address.component_id = component_id;
+    dispatcher.communicator_address = _address;
+
+    // Adiciona o observador à lista de observadores do protocolo
+    _protocol->attach(&dispatcher);
+}
+
+AsyncCommunicator::~AsyncCommunicator() {
+    // Após o detach nenhuma mensagem nova é despachada; espera as mensagens já na fila
+    _protocol->detach(&dispatcher);
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    closing = true;
+    space.notify_all();
+    drained.wait(lock, [&]() { return pumps == 0; });
+}
+
+size_t AsyncCommunicator::AddressHash::operator()(const Ethernet::Address& address) const {
+    uint64_t hash = static_cast<uint64_t>(address.component_id) * 0x9E3779B97F4A7C15ULL;
+    for (uint8_t byte : address.vehicle_id) {
+        hash = (hash ^ byte) * 0x100000001B3ULL;
+    }
+    return static_cast<size_t>(hash);
+}
+
+std::shared_ptr<AsyncCommunicator::Binding> AsyncCommunicator::bind(Handler handler, bool serialized) {
+    auto binding = std::make_shared<Binding>();
+    binding->handler = std::move(handler);
+    binding->serialized = serialized;
+    return binding;
+}
+
+void AsyncCommunicator::on(Ethernet::Type type, Handler handler, bool serialized) {
+    auto binding = bind(std::move(handler), serialized);
+    handlers.update([&](Handlers& table) { table.by_type[type] = binding; });
+}
+
+void AsyncCommunicator::on_source(Ethernet::Address source, Handler handler, bool serialized) {
+    auto binding = bind(std::move(handler), serialized);
+    handlers.update([&](Handlers& table) { table.by_source[source] = binding; });
+}
+
+void AsyncCommunicator::on_any(Handler handler, bool serialized) {
+    auto binding = bind(std::move(handler), serialized);
+    handlers.update([&](Handlers& table) { table.any = binding; });
+}
+
+void AsyncCommunicator::Dispatcher::update(const MessageRef& message) {
+    owner->dispatch(message);
+}
+
+// Mensagens que uma tarefa de entrega trata antes de devolver sua thread ao executor
+static const int PUMP_BURST = 16;
+
+bool AsyncCommunicator::conflates(const MessageRef& message) const {
+    if (!_config.conflate) {
+        return false;
+    }
+    if (_config.conflate_types.empty()) {
+        return true;
+    }
+    Ethernet::Type type = message.getType();
+    return std::find(_config.conflate_types.begin(), _config.conflate_types.end(), type) != _config.conflate_types.end();
+}
+
+// Escolhe o handler (origem, tipo ou qualquer) e enfileira a mensagem, aplicando a
+// conflação e a política de estouro; posta uma tarefa de entrega se faltar alguma.
+void AsyncCommunicator::dispatch(const MessageRef& message) {
+    std::shared_ptr<Binding> binding;
+    {
+        auto table = handlers.read();
+        if (!table->by_source.empty()) {
+            auto it = table->by_source.find(message.getSrcAddress());
+            if (it != table->by_source.end()) {
+                binding = it->second;
+            }
+        }
+        if (!binding) {
+            auto it = table->by_type.find(message.getType());
+            binding = it != table->by_type.end() ? it->second : table->any;
+        }
+    }
+    if (!binding) {
+        unhandled.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // A fila guarda a referência à mensagem (copiada apenas com o pool da NIC baixo)
+    MessageRef held = message.hold();
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    if (closing) {
+        stats.messages_dropped++;
+        return;
+    }
+
+    // Conflação: substitui a mensagem pendente de mesma origem e tipo, sem ocupar outra posição
+    if (conflates(message)) {
+        Ethernet::Address source = message.getSrcAddress();
+        Ethernet::Type type = message.getType();
+        for (Job& job : queue) {
+            if (job.binding == binding && job.message.getType() == type && job.message.getSrcAddress() == source) {
+                job.message = std::move(held);
+                stats.messages_conflated++;
+                return;
+            }
+        }
+    }
+
+    if (queue.size() >= _config.capacity) {
+        switch (_config.overflow) {
+            case Concurrent_Observer::Overflow::DROP_NEWEST:
+                stats.messages_dropped++;
+                return;
+            case Concurrent_Observer::Overflow::DROP_OLDEST:
+                // A mais antiga ainda não começou (as que começaram já saíram da fila)
+                queue.pop_front();
+                stats.messages_overwritten++;
+                break;
+            case Concurrent_Observer::Overflow::BLOCK:
+                // Uma thread do executor (um handler que envia) pode ser a que esvaziaria a fila
+                if (_executor->in_pool()) {
+                    stats.messages_dropped++;
+                    return;
+                }
+                stats.producer_waits++;
+                space.wait(lock, [&]() { return queue.size() < _config.capacity || closing; });
+                if (closing) {
+                    stats.messages_dropped++;
+                    return;
+                }
+                break;
+        }
+    }
+
+    queue.push_back(Job{std::move(held), std::move(binding)});
+    stats.high_water = std::max(stats.high_water, queue.size());
+
+    // No máximo uma tarefa de entrega por mensagem na fila
+    if (pumps >= queue.size()) {
+        return;
+    }
+    pumps++;
+    lock.unlock();
+    _executor->post([this]() { pump(); });
+}
+
+// Tarefa de entrega: retira a mensagem mais antiga cujo handler pode rodar (um
+// serializado roda uma mensagem por vez) e a entrega, por uma rajada de mensagens.
+// Termina quando nenhuma pode rodar; a tarefa que está com o handler serializado
+// entrega as mensagens seguintes dele.
+void AsyncCommunicator::pump() {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    for (int i = 0; i < PUMP_BURST; ++i) {
+        auto it = std::find_if(queue.begin(), queue.end(), [](const Job& job) { return !job.binding->running; });
+        if (it == queue.end()) {
+            if (--pumps == 0) {
+                drained.notify_all();
+            }
+            return;
+        }
+        Job job = std::move(*it);
+        queue.erase(it);
+        job.binding->running = job.binding->serialized;
+        stats.messages_dispatched++;
+        if (_config.overflow == Concurrent_Observer::Overflow::BLOCK) {
+            space.notify_one();
+        }
+        lock.unlock();
+
+        job.binding->handler(job.message);
+        job.message = MessageRef();   // Devolve o buffer fora do lock
+
+        lock.lock();
+        job.binding->running = false;
+    }
+
+    // Rajada completa: devolve a thread e continua numa nova tarefa (a contagem não muda)
+    lock.unlock();
+    _executor->post([this]() { pump(); });
+}
+
+bool AsyncCommunicator::send(Message* message) {
+    return (_protocol->send(_address, message->getDstAddress(), message->getType(),
+            message->getPeriod(), message->getGroupID(), message->getMAC(), message->data(), message->size()) > 0);
+}
+
+size_t AsyncCommunicator::send_many(Message* messages, size_t count) {
+    size_t sent = 0;
+    _protocol->begin_batch();
+    for (size_t i = 0; i < count; i++) {
+        if (send(&messages[i])) {
+            sent++;
+        }
+    }
+    _protocol->end_batch();
+    return sent;
+}
+
+Ethernet::Address AsyncCommunicator::address() const {
+    return _address;
+}
+
+Concurrent_Observer* AsyncCommunicator::getObserver() {
+    return &dispatcher;
+}
+
+AsyncCommunicator::Statistics AsyncCommunicator::statistics() const {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    Statistics result = stats;
+    result.messages_unhandled = unhandled.load(std::memory_order_relaxed);
+    return result;
+}
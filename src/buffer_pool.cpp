@@ -0,0 +1,104 @@
+#include "../include/buffer_pool.hpp"
+
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include <sys/mman.h>
+
+// Tamanho de uma hugepage (x86-64 e aarch64 com páginas de 4 KB)
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Construtor: reserva todos os blocos e os coloca na pilha de livres
+BufferPool::BufferPool(size_t block_size, const Config& config)
+    : block_size((block_size + 63) & ~static_cast<size_t>(63)),
+      capacity(config.capacity > 0 ? config.capacity : 1),
+      reserve(config.reserve > 0 ? std::min(config.reserve, capacity) : capacity / 4) {
+    memory_size = this->block_size * capacity;
+
+    void* map = MAP_FAILED;
+    if (config.huge_pages) {
+        size_t huge_size = (memory_size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        map = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (map != MAP_FAILED) {
+            memory_size = huge_size;
+            huge_pages = true;
+        } else {
+            std::cerr << "Aviso: hugepages indisponíveis para o pool de buffers, usando páginas normais" << std::endl;
+        }
+    }
+    if (map == MAP_FAILED) {
+        map = mmap(nullptr, memory_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (map == MAP_FAILED) {
+        perror("Erro ao reservar memória do pool de buffers");
+        exit(EXIT_FAILURE);
+    }
+    memory = static_cast<uint8_t*>(map);
+
+    // Encadeia todos os blocos: 0 -> 1 -> ... -> capacity - 1
+    next = new std::atomic<uint32_t>[capacity];
+    for (uint32_t i = 0; i < capacity; ++i) {
+        next[i].store(i + 1 < capacity ? i + 1 : EMPTY, std::memory_order_relaxed);
+    }
+    head.store(0, std::memory_order_release);
+}
+
+// Destrutor
+BufferPool::~BufferPool() {
+    munmap(memory, memory_size);
+    delete[] next;
+}
+
+// Retira um bloco do topo da pilha de livres
+void* BufferPool::acquire() {
+    uint64_t top = head.load(std::memory_order_acquire);
+    while (true) {
+        uint32_t index = static_cast<uint32_t>(top);
+        if (index == EMPTY) {
+            exhausted.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        // Se outro thread mudar o topo entre a leitura e o CAS, a versão muda e o CAS falha
+        uint64_t version = (top >> 32) + 1;
+        uint64_t desired = (version << 32) | next[index].load(std::memory_order_relaxed);
+        if (head.compare_exchange_weak(top, desired, std::memory_order_acquire, std::memory_order_acquire)) {
+            acquired.fetch_add(1, std::memory_order_relaxed);
+            uint64_t used = in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+            uint64_t peak = high_water.load(std::memory_order_relaxed);
+            while (used > peak && !high_water.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {}
+            return memory + static_cast<size_t>(index) * block_size;
+        }
+    }
+}
+
+// Coloca um bloco no topo da pilha de livres
+void BufferPool::release(void* block) {
+    uint32_t index = static_cast<uint32_t>((static_cast<uint8_t*>(block) - memory) / block_size);
+    uint64_t top = head.load(std::memory_order_relaxed);
+    while (true) {
+        next[index].store(static_cast<uint32_t>(top), std::memory_order_relaxed);
+        uint64_t desired = (((top >> 32) + 1) << 32) | index;
+        if (head.compare_exchange_weak(top, desired, std::memory_order_release, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    in_use.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// Verifica se o endereço pertence a um bloco do pool
+bool BufferPool::contains(const void* block) const {
+    const uint8_t* address = static_cast<const uint8_t*>(block);
+    return address >= memory && address < memory + static_cast<size_t>(capacity) * block_size;
+}
+
+// Retorna os contadores do pool
+BufferPool::Statistics BufferPool::statistics() const {
+    Statistics stats;
+    stats.capacity = capacity;
+    stats.in_use = in_use.load(std::memory_order_relaxed);
+    stats.high_water = high_water.load(std::memory_order_relaxed);
+    stats.acquired = acquired.load(std::memory_order_relaxed);
+    stats.exhausted = exhausted.load(std::memory_order_relaxed);
+    stats.huge_pages = huge_pages;
+    return stats;
+}
@@ -2,8 +2,14 @@
 #include "../include/message.hpp"
 #include "../include/protocol.hpp"
 
+#include <algorithm>
+
 Communicator::Communicator(Protocol* protocol, Mac_Address vehicle_id, Thread_ID component_id)
-    : _protocol(protocol) 
+    : Communicator(protocol, vehicle_id, component_id, Concurrent_Observer::Config()) {}
+
+Communicator::Communicator(Protocol* protocol, Mac_Address vehicle_id, Thread_ID component_id,
+                           const Concurrent_Observer::Config& queue_config)
+    : _protocol(protocol), observer(queue_config)
 {
     // Inicializa endereço do comunicador: identificador do veiculo (MAC da nic) e identificador do componente.
     _address.vehicle_id = vehicle_id;
@@ -18,6 +24,8 @@ Communicator::Communicator(Protocol* protocol, Mac_Address vehicle_id, Thread_ID
 }
 
 Communicator::~Communicator() {
+    // Libera produtores bloqueados na fila cheia (BLOCK), que impediriam o detach de retornar
+    observer.close();
     // Desanexa o observador do protocolo quando o comunicador for destruído
     _protocol->detach(&observer);
 }
@@ -30,23 +38,77 @@ bool Communicator::send(Message* message) {
 bool Communicator::receive(Message* message) {
     // Aguarda até que uma mensagem seja recebida
     // Chama o método updated() do observador para bloquear até receber uma mensagem
-    Message received_message = observer.updated();
-
-    // Extrai o cabeçalho da mensagem recebida
-    message->setSrcAddress(received_message.getSrcAddress());
-    message->setDstAddress(received_message.getDstAddress());
-    message->setType(received_message.getType());
-    message->setPeriod(received_message.getPeriod());
-    message->setTimestamp(received_message.getTimestamp());
-    message->setGroupID(received_message.getGroupID());
-    message->setMAC(received_message.getMAC());
-    
-    // Copia o conteúdo da mensagem recebida para a mensagem do comunicador.
-    message->setData(received_message.data(), received_message.size());
+    MessageRef received_message = observer.updated();
+
+    // Copia o cabeçalho e o conteúdo da mensagem recebida para a mensagem do comunicador.
+    received_message.copyTo(message);
+
+    return true;
+}
+
+bool Communicator::receive(MessageRef* message) {
+    // Aguarda até que uma mensagem seja recebida e guarda apenas a referência
+    *message = observer.updated();
+    return true;
+}
+
+bool Communicator::receive_for(Message* message, std::chrono::steady_clock::duration timeout) {
+    return receive_until(message, std::chrono::steady_clock::now() + timeout);
+}
 
+bool Communicator::receive_for(MessageRef* message, std::chrono::steady_clock::duration timeout) {
+    return receive_until(message, std::chrono::steady_clock::now() + timeout);
+}
+
+bool Communicator::receive_until(Message* message, std::chrono::steady_clock::time_point deadline) {
+    MessageRef received_message;
+    if (!observer.updated_until(&received_message, deadline)) {
+        return false;
+    }
+    received_message.copyTo(message);
     return true;
 }
 
+bool Communicator::receive_until(MessageRef* message, std::chrono::steady_clock::time_point deadline) {
+    return observer.updated_until(message, deadline);
+}
+
+size_t Communicator::receive_many(Message* messages, size_t max, std::chrono::steady_clock::duration timeout) {
+    MessageRef received[32];
+    size_t total = 0;
+    // Copia em blocos de até 32 referências; só o primeiro bloco espera pelo prazo
+    while (total < max) {
+        size_t wanted = std::min(max - total, sizeof(received) / sizeof(received[0]));
+        auto deadline = total == 0 ? std::chrono::steady_clock::now() + timeout : std::chrono::steady_clock::time_point();
+        size_t n = observer.updated_many(received, wanted, deadline);
+        for (size_t i = 0; i < n; i++) {
+            received[i].copyTo(&messages[total + i]);
+            received[i] = MessageRef();
+        }
+        total += n;
+        if (n < wanted) {
+            break;
+        }
+    }
+    return total;
+}
+
+size_t Communicator::receive_many(MessageRef* messages, size_t max, std::chrono::steady_clock::duration timeout) {
+    return observer.updated_many(messages, max, std::chrono::steady_clock::now() + timeout);
+}
+
+size_t Communicator::send_many(Message* messages, size_t count) {
+    size_t sent = 0;
+    _protocol->begin_batch();
+    for (size_t i = 0; i < count; i++) {
+        if (send(&messages[i])) {
+            sent++;
+        }
+    }
+    _protocol->end_batch();
+    return sent;
+}
+
 bool Communicator::hasMessage() {
     // Verifica se há mensagens disponíveis no observador
     return observer.hasMessage();
@@ -55,3 +117,7 @@ bool Communicator::hasMessage() {
 Concurrent_Observer* Communicator::getObserver() {
     return &observer;
 }
+
+Concurrent_Observer::Statistics Communicator::queueStatistics() {
+    return observer.statistics();
+}
@@ -1,124 +1,364 @@
 #include "../include/data_publisher.hpp"
 
+#include <algorithm>
+#include <cstring>
+
+// Construtor que define o número de threads do escalonador de publicações.
+DataPublisher::DataPublisher(unsigned int publisher_threads)
+    : scheduler(publisher_threads) {}
+
+// Retorna a posição do tipo na tabela: a da sua entrada ou a da primeira livre da sondagem.
+size_t DataPublisher::SubscriptionTable::position(Ethernet::Type type) const {
+    size_t mask = entries.size() - 1;
+    size_t i = (static_cast<uint64_t>(type) * 0x9E3779B97F4A7C15ULL >> 32) & mask;
+    while (entries[i].used && entries[i].type != type) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+// Garante espaço para mais 'types' tipos, refazendo a tabela (sem os tipos sem inscritos) se preciso.
+void DataPublisher::SubscriptionTable::reserve(size_t types) {
+    if (2 * (used + types) <= entries.size()) {
+        return;
+    }
+    std::vector<Entry> old_entries;
+    old_entries.swap(entries);
+    used = 0;
+    for (const Entry& entry : old_entries) {
+        if (entry.used && !entry.observers->empty()) {
+            used++;
+        }
+    }
+    size_t capacity = 8;
+    while (capacity < 2 * (used + types)) {
+        capacity <<= 1;
+    }
+    entries.resize(capacity);
+    for (Entry& entry : old_entries) {
+        if (entry.used && !entry.observers->empty()) {
+            entries[position(entry.type)] = std::move(entry);
+        }
+    }
+}
+
+// Retorna os inscritos no tipo (nullptr se não houver nenhum).
+const DataPublisher::SubscriptionTable::Observers* DataPublisher::SubscriptionTable::find(Ethernet::Type type) const {
+    if (entries.empty()) {
+        return nullptr;
+    }
+    const Entry& entry = entries[position(type)];
+    return entry.used ? entry.observers.get() : nullptr;
+}
+
+// Adiciona o observador à lista de cada tipo (uma vez por tipo).
+void DataPublisher::SubscriptionTable::add(Concurrent_Observer* observer, const std::vector<Ethernet::Type>& types) {
+    reserve(types.size());
+    for (Ethernet::Type type : types) {
+        Entry& entry = entries[position(type)];
+        if (!entry.used) {
+            entry.used = true;
+            entry.type = type;
+            entry.observers = std::make_shared<const Observers>(Observers{observer});
+            used++;
+        } else if (std::find(entry.observers->begin(), entry.observers->end(), observer) == entry.observers->end()) {
+            auto observers = std::make_shared<Observers>(*entry.observers);
+            observers->push_back(observer);
+            entry.observers = std::move(observers);
+        }
+    }
+}
+
+// Remove o observador da lista de cada tipo (a entrada fica vazia até a tabela ser refeita).
+void DataPublisher::SubscriptionTable::remove(Concurrent_Observer* observer, const std::vector<Ethernet::Type>& types) {
+    if (entries.empty()) {
+        return;
+    }
+    for (Ethernet::Type type : types) {
+        Entry& entry = entries[position(type)];
+        if (!entry.used) {
+            continue;
+        }
+        auto it = std::find(entry.observers->begin(), entry.observers->end(), observer);
+        if (it != entry.observers->end()) {
+            auto observers = std::make_shared<Observers>(entry.observers->begin(), it);
+            observers->insert(observers->end(), it + 1, entry.observers->end());
+            entry.observers = std::move(observers);
+        }
+    }
+}
+
 // Inscreve um observador para receber mensagens de tipos específicos.
 void DataPublisher::subscribe(Concurrent_Observer* obsCommunicator, std::vector<Ethernet::Type>* types) {
     std::lock_guard<std::mutex> lock(subscribers_mutex);
-    subscribers[obsCommunicator] = types;
+    // Uma nova inscrição do mesmo observador substitui a anterior.
+    auto previous = subscribers.find(obsCommunicator);
+    std::vector<Ethernet::Type> old_types;
+    if (previous != subscribers.end()) {
+        old_types = previous->second;
+    }
+    subscribers[obsCommunicator] = *types;
+    subscriptions.update([&](SubscriptionTable& table) {
+        table.remove(obsCommunicator, old_types);
+        table.add(obsCommunicator, *types);
+    });
 }
 
-// Remove um observador da lista de inscritos e encerra suas threads periódicas.
+// Remove um observador da lista de inscritos e encerra suas publicações periódicas.
 void DataPublisher::unsubscribe(Concurrent_Observer* obsCommunicator) {
     {
         std::lock_guard<std::mutex> lock(subscribers_mutex);
-        subscribers.erase(obsCommunicator);
+        auto sub = subscribers.find(obsCommunicator);
+        if (sub != subscribers.end()) {
+            // Retorna quando nenhum notify usa mais a tabela antiga (sem criar novas publicações para o observador).
+            subscriptions.update([&](SubscriptionTable& table) {
+                table.remove(obsCommunicator, sub->second);
+            });
+            subscribers.erase(sub);
+        }
     }
 
-    delete_periodic_thread(obsCommunicator);
-
-    std::lock_guard<std::mutex> lock(threads_mutex);
-    threads.erase(obsCommunicator);
+    // Retira o observador de todos os interesses periódicos.
+    retire_interests([&](Interest& interest) {
+        auto& observers = interest.observers;
+        observers.erase(std::remove(observers.begin(), observers.end(), obsCommunicator), observers.end());
+        return observers.empty();
+    });
 }
 
 // Verifica quais observadores estão interessados na mensagem e os notifica.
-void DataPublisher::notify(Message message) {
+void DataPublisher::notify(const MessageRef& message) {
     Ethernet::Type msg_type = message.getType();
     Ethernet::Period period = message.getPeriod();
 
-    std::lock_guard<std::mutex> lock(subscribers_mutex);
-    for (auto& sub : subscribers) {
-        for (auto& type : *(sub.second)) {
-            if (type == msg_type) {
-                // Envia diretamente se não for periódico
-                if (period <= 0) {
-                    sub.first->update(message);
-                } else {
-                    // Cria thread periódica para mensagens com período > 0
-                    create_periodic_thread(sub.first, message);
-                }
-                break; // Já encontrou o tipo desejado, pula para o próximo inscrito
-            }
-        }
+    if (msg_type == Ethernet::TYPE_INTEREST_CANCEL) {
+        cancel_interest(message);
+        return;
+    }
+
+    // Consulta apenas os inscritos no tipo da mensagem, sem locks.
+    auto table = subscriptions.read();
+    const SubscriptionTable::Observers* observers = table->find(msg_type);
+    if (observers == nullptr || observers->empty()) {
+        return;
+    }
+    if (period > 0) {
+        // Agenda publicação periódica para mensagens com período > 0
+        create_periodic_stream(*observers, message);
+        return;
+    }
+    // Envia diretamente se não for periódico
+    for (Concurrent_Observer* obs : *observers) {
+        obs->update(message);
     }
 }
 
-// Cria uma thread periódica para enviar a mensagem ao observador especificado.
-void DataPublisher::create_periodic_thread(Concurrent_Observer* obsCommunicator, Message message) {
+// Agenda o interesse no fluxo do tipo de maior período base que divide o seu período
+// (ou em um novo fluxo), de modo que o número de tarefas cresça com os períodos distintos.
+void DataPublisher::create_periodic_stream(const SubscriptionTable::Observers& observers, const MessageRef& message) {
+    Ethernet::Type type = message.getType();
     Ethernet::Period period = message.getPeriod();
-    std::chrono::milliseconds period_ms(period); // Converte para milissegundos
+    Ethernet::Address source = message.getSrcAddress();
+
+    // Validade opcional do interesse, enviada nos dados da mensagem.
+    Ethernet::InterestLease lease;
+    if (message.size() >= sizeof(lease)) {
+        std::memcpy(&lease, message.data(), sizeof(lease));
+    }
+    auto expires = PeriodicScheduler::Clock::time_point::max();
+    if (lease.lease_ms > 0) {
+        expires = PeriodicScheduler::Clock::now() + std::chrono::milliseconds(lease.lease_ms);
+    }
 
-    // Aloca variáveis de controle da thread
-    auto* stop_flag = new bool(false);
-    auto* cv = new std::condition_variable();
-    auto* mtx = new std::mutex();
+    // Um interesse anterior do consumidor no tipo com outro período é substituído.
+    retire_interests([&](Interest& interest) {
+        return interest.message.getType() == type && interest.message.getPeriod() != period
+            && interest.message.getSrcAddress() == source;
+    });
 
-    // Cria a thread com a função de loop de envio
-    std::thread t(&DataPublisher::publish_loop, this, cv, mtx, stop_flag, obsCommunicator, message, period_ms);
+    std::lock_guard<std::mutex> lock(streams_mutex);
+    if (lease.lease_ms > 0 && lease_sweeper == 0) {
+        lease_sweeper = scheduler.add(LEASE_SWEEP_PERIOD, [this]() {
+            auto now = PeriodicScheduler::Clock::now();
+            retire_interests([&](Interest& interest) { return interest.expires <= now; });
+        });
+    }
+
+    std::shared_ptr<Stream> chosen;
+    for (const std::shared_ptr<Stream>& stream : streams[type]) {
+        std::lock_guard<std::mutex> stream_lock(stream->mutex);
+        for (Interest& interest : stream->interests) {
+            // Mesmo consumidor e mesmo período: apenas renova o interesse.
+            if (interest.message.getPeriod() == period && interest.message.getSrcAddress() == source) {
+                interest.expires = expires;
+                return;
+            }
+        }
+        if (period % stream->base == 0 && (!chosen || stream->base > chosen->base)) {
+            chosen = stream;
+        }
+    }
 
-    // Armazena os recursos da thread
-    ThreadControl control{ std::move(t), message, cv, mtx, stop_flag };
+    if (chosen) {
+        std::lock_guard<std::mutex> stream_lock(chosen->mutex);
+        chosen->interests.push_back(Interest{message.copy(), observers, static_cast<uint64_t>(period / chosen->base),
+                                             chosen->tick, expires});
+        live_interests++;
+        return;
+    }
 
-    std::lock_guard<std::mutex> lock(threads_mutex);
-    threads[obsCommunicator].push_back(std::move(control));
+    auto stream = std::make_shared<Stream>();
+    stream->type = type;
+    stream->base = period;
+    stream->interests.push_back(Interest{message.copy(), observers, 1, 0, expires});
+    stream->handle = scheduler.add(std::chrono::milliseconds(period), [stream]() { publish(*stream); });
+    streams[type].push_back(std::move(stream));
+    live_interests++;
+    streams_created++;
 }
 
-// Encerra todas as threads periódicas associadas a um observador.
-void DataPublisher::delete_periodic_thread(Concurrent_Observer* obsCommunicator) {
-    std::lock_guard<std::mutex> lock(threads_mutex);
+// Encerra os interesses periódicos do remetente no tipo cancelado.
+void DataPublisher::cancel_interest(const MessageRef& message) {
+    Ethernet::Type type;
+    if (message.size() < sizeof(type)) {
+        return;
+    }
+    std::memcpy(&type, message.data(), sizeof(type));
+    Ethernet::Address source = message.getSrcAddress();
+    retire_interests([&](Interest& interest) {
+        return interest.message.getType() == type && interest.message.getSrcAddress() == source;
+    });
+}
 
-    for (auto& control : threads[obsCommunicator]) {
-        {
-            std::lock_guard<std::mutex> lock(*control.mtx);
-            *control.stop_flag = true; // Sinaliza a parada da thread
+// Dispara um tick do fluxo, entregando cada interesse que vence nele a todos os seus observadores.
+void DataPublisher::publish(Stream& stream) {
+    std::lock_guard<std::mutex> lock(stream.mutex);
+    uint64_t tick = ++stream.tick;
+    auto now = PeriodicScheduler::Clock::now();
+    for (const Interest& interest : stream.interests) {
+        // Interesses expirados deixam de ser entregues e são removidos pela varredura de leases.
+        if ((tick - interest.start) % interest.every == 0 && interest.expires > now) {
+            for (Concurrent_Observer* obs : interest.observers) {
+                obs->update(interest.message); // Envia mensagem
+            }
         }
-        control.cv->notify_all(); // Acorda a thread, se estiver dormindo
     }
+}
 
-    for (auto& control : threads[obsCommunicator]) {
-        if (control.thread.joinable())
-            control.thread.join(); // Aguarda finalização
+// Remove interesses e encerra os fluxos que ficaram sem nenhum.
+size_t DataPublisher::retire_interests(const std::function<bool(Interest&)>& retire) {
+    std::vector<PeriodicScheduler::Handle> removed;
+    size_t retired = 0;
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex);
+        for (auto type_it = streams.begin(); type_it != streams.end();) {
+            auto& type_streams = type_it->second;
+            for (auto it = type_streams.begin(); it != type_streams.end();) {
+                Stream& stream = **it;
+                {
+                    // Depois deste bloco nenhum tick entrega mais os interesses removidos.
+                    std::lock_guard<std::mutex> stream_lock(stream.mutex);
+                    std::vector<Interest> kept;
+                    for (Interest& interest : stream.interests) {
+                        if (!retire(interest)) {
+                            kept.push_back(std::move(interest));
+                        }
+                    }
+                    retired += stream.interests.size() - kept.size();
+                    stream.interests.swap(kept);
+                }
+                if (stream.interests.empty()) {
+                    removed.push_back(stream.handle);
+                    it = type_streams.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            type_it = type_streams.empty() ? streams.erase(type_it) : std::next(type_it);
+        }
+        live_interests -= retired;
+        interests_retired += retired;
+        streams_retired += removed.size();
+    }
 
-        // Libera os recursos alocados
-        delete control.cv;
-        delete control.mtx;
-        delete control.stop_flag;
+    // Fora dos locks: remove() espera o tick em andamento, que usa o mutex do fluxo.
+    for (PeriodicScheduler::Handle handle : removed) {
+        PeriodicScheduler::Statistics final_stats;
+        if (scheduler.remove(handle, &final_stats)) {
+            // Os disparos do fluxo continuam contando nas estatísticas depois do seu fim.
+            std::lock_guard<std::mutex> lock(streams_mutex);
+            retired_releases += final_stats.releases;
+            retired_deadline_misses += final_stats.deadline_misses;
+            retired_max_jitter = std::max(retired_max_jitter, final_stats.max_jitter);
+            retired_total_jitter += final_stats.mean_jitter * final_stats.releases;
+        }
     }
+    return retired;
 }
 
-// Loop que roda dentro de cada thread periódica
-void DataPublisher::publish_loop(std::condition_variable* cv, std::mutex* mtx, bool* stop_flag,
-                                 Concurrent_Observer* obsCommunicator, Message message,
-                                 std::chrono::milliseconds period_ms) {
-    auto next_send = std::chrono::steady_clock::now() + period_ms;
-    std::unique_lock<std::mutex> lock(*mtx);
+// Encerra todas as publicações periodicas associadas a um determinado grupo.
+// Retorna quando nenhum tick entrega mais os interesses do grupo; o tempo gasto
+// (custo da troca de grupo) é registrado nas estatísticas.
+size_t DataPublisher::delete_group_threads(Ethernet::Quadrant_ID group_id) {
+    auto start = std::chrono::steady_clock::now();
 
-    while (!(*stop_flag)) {
-        obsCommunicator->update(message); // Envia mensagem
-        next_send += period_ms;           // Define o próximo instante de envio
+    // Se for interesse externo e do grupo: encerra a publicação periódica.
+    size_t retired = retire_interests([&](Interest& interest) {
+        return interest.message.getSrcAddress().vehicle_id != interest.message.getDstAddress().vehicle_id
+            && interest.message.getGroupID() == group_id;
+    });
 
-        // Aguarda até o próximo envio ou até ser sinalizado para parar
-        cv->wait_until(lock, next_send, [&]() { return *stop_flag; });
-    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    std::lock_guard<std::mutex> lock(streams_mutex);
+    group_retirements++;
+    last_group_retirement = elapsed;
+    max_group_retirement = std::max(max_group_retirement, elapsed);
+    return retired;
 }
 
-// Encerra todas as threads periodicas associadas a um determinado grupo.
-void DataPublisher::delete_group_threads(Ethernet::Quadrant_ID group_id) {
-    std::lock_guard<std::mutex> lock(threads_mutex);
-    for (auto& [obs, vector] : threads) { // Itera sobre os componentes inscritos.
-        for (auto& control : vector) {  // Itera sobre as threads periodicas de cada inscrito.
-            // Se for interesse externo e do grupo: finaliza thread periodica.
-            if (control.message.getSrcAddress().vehicle_id != control.message.getDstAddress().vehicle_id) {
-                if (control.message.getGroupID() == group_id) {
-                    {
-                        std::lock_guard<std::mutex> lock(*control.mtx);
-                        *control.stop_flag = true; // Sinaliza a parada da thread
-                    }
-                    control.cv->notify_all();
-                    // Libera os recursos alocados
-                    delete control.cv;
-                    delete control.mtx;
-                    delete control.stop_flag;
-                }
-            }
+// Retorna os contadores de fluxos e interesses periódicos.
+DataPublisher::Statistics DataPublisher::statistics() const {
+    std::lock_guard<std::mutex> lock(streams_mutex);
+    Statistics stats;
+
+    // Disparos dos fluxos ativos somados aos dos já encerrados.
+    stats.releases = retired_releases;
+    stats.deadline_misses = retired_deadline_misses;
+    stats.max_jitter = retired_max_jitter;
+    std::chrono::microseconds total_jitter = retired_total_jitter;
+    for (const PeriodicScheduler::Statistics& live : scheduler.statistics()) {
+        if (live.handle == lease_sweeper) {
+            continue;
         }
+        stats.releases += live.releases;
+        stats.deadline_misses += live.deadline_misses;
+        stats.max_jitter = std::max(stats.max_jitter, live.max_jitter);
+        total_jitter += live.mean_jitter * live.releases;
+    }
+    if (stats.releases > 0) {
+        stats.mean_jitter = total_jitter / stats.releases;
     }
+
+    for (const auto& type_streams : streams) {
+        stats.live_streams += type_streams.second.size();
+    }
+    stats.live_interests = live_interests;
+    stats.streams_created = streams_created;
+    stats.streams_retired = streams_retired;
+    stats.interests_retired = interests_retired;
+    stats.group_retirements = group_retirements;
+    stats.last_group_retirement = last_group_retirement;
+    stats.max_group_retirement = max_group_retirement;
+    return stats;
+}
+
+// Retorna as estatísticas dos fluxos periódicos ativos.
+std::vector<PeriodicScheduler::Statistics> DataPublisher::periodic_statistics() const {
+    std::vector<PeriodicScheduler::Statistics> statistics = scheduler.statistics();
+    // A varredura de leases não é um fluxo.
+    std::lock_guard<std::mutex> lock(streams_mutex);
+    statistics.erase(std::remove_if(statistics.begin(), statistics.end(),
+                                    [&](const PeriodicScheduler::Statistics& stats) { return stats.handle == lease_sweeper; }),
+                     statistics.end());
+    return statistics;
 }
@@ -1,4 +1,5 @@
 #include "../include/engine.hpp"
+#include "../include/reactor.hpp"
 #include <iostream>
 #include <cstring>
 #include <unistd.h>
@@ -10,210 +11,357 @@
 #include <linux/if_ether.h>
 #include <thread>
 #include <cstdlib>
-#include <queue>
 #include <mutex>
-#include <condition_variable>
-#include <csignal>
-#include <fcntl.h>
-#include <semaphore.h>
+#include <sys/mman.h>
+#include <linux/filter.h>
 
-// Static pointer to the Engine instance for signal handling
-static Engine* instance = nullptr;
+// Constructor
+Engine::Engine(const std::string& interface, Callback callback, bool enable_receive)
+    : Engine(interface, callback, enable_receive, Config()) {}
+
+// Constructor with explicit configuration
+Engine::Engine(const std::string& interface, Callback callback, bool enable_receive, const Config& config)
+    : _interface(interface), _callback(callback), _socket(-1), _config(config) {
+    // Resolve the network interface index once
+    int ifindex = static_cast<int>(if_nametoindex(interface.c_str()));
+    if (ifindex == 0) {
+        perror("Error getting interface index");
+        exit(EXIT_FAILURE);
+    }
 
-// Declare a semaphore for signaling
-static sem_t receive_semaphore;
+    // Configure the broadcast destination address used by every send
+    _dest_addr.sll_family   = AF_PACKET;
+    _dest_addr.sll_ifindex  = ifindex;
+    _dest_addr.sll_protocol = htons(ETH_P_ALL);
+    _dest_addr.sll_halen    = ETH_ALEN;
+    std::memset(_dest_addr.sll_addr, 0xFF, 6);
 
-// Signal handler for SIGIO
-void Engine::sigio_handler(int /*signum*/) {
-    // Post to the semaphore to signal the receive loop
-    sem_post(&receive_semaphore);
-}
+    // Preallocate the transmit batch queue
+    if (_config.tx_batch_size == 0) {
+        _config.tx_batch_size = 1;
+    }
+    tx_slots.resize(static_cast<size_t>(_config.tx_batch_size) * TX_SLOT_SIZE);
+    tx_iov.resize(_config.tx_batch_size);
+    tx_msgs.resize(_config.tx_batch_size);
+    for (size_t i = 0; i < _config.tx_batch_size; ++i) {
+        tx_iov[i].iov_base = &tx_slots[i * TX_SLOT_SIZE];
+        tx_msgs[i].msg_hdr = {};
+        tx_msgs[i].msg_hdr.msg_name = &_dest_addr;
+        tx_msgs[i].msg_hdr.msg_namelen = sizeof(_dest_addr);
+        tx_msgs[i].msg_hdr.msg_iov = &tx_iov[i];
+        tx_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
 
-// Constructor
-Engine::Engine(const std::string& interface, Callback callback, bool enable_receive)
-    : _interface(interface), _callback(callback), _socket(-1) {
-    instance = this; // Set the global instance pointer
+    // Open the channels: with fanout every socket receives a share of the frames
+    unsigned int channel_count = (enable_receive && _config.fanout > 1) ? _config.fanout : 1;
+    channels.resize(channel_count);
+    for (Channel& channel : channels) {
+        open_channel(channel, ifindex, enable_receive);
+    }
+    _socket = channels[0].socket;
 
-    // Initialize the semaphore
-    if (sem_init(&receive_semaphore, 0, 0) != 0) {
-        perror("Error initializing semaphore");
-        exit(EXIT_FAILURE);
+    // Join the channels in one fanout group (falls back to a single channel)
+    if (channels.size() > 1 && !join_fanout()) {
+        while (channels.size() > 1) {
+            close_channel(channels.back());
+            channels.pop_back();
+        }
+    }
+
+    // Register the sockets in the shared reactor, which delivers frames to the callback
+    if (enable_receive) {
+        Reactor::reserve_threads(static_cast<unsigned int>(channels.size()));
+        for (Channel& channel : channels) {
+            Channel* ch = &channel;
+            if (channel.ring != nullptr) {
+                channel.reactor_id = Reactor::instance().add(channel.socket, [this, ch]() { receive_ring(*ch); });
+            } else {
+                channel.reactor_id = Reactor::instance().add(channel.socket, [this, ch]() { receive_socket(*ch); });
+            }
+        }
     }
+}
 
+// Method to open one raw socket bound to the interface
+void Engine::open_channel(Channel& channel, int ifindex, bool enable_receive) {
     // Create a raw socket to capture Ethernet packets
-    _socket = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
-    if (_socket < 0) {
+    channel.socket = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (channel.socket < 0) {
         perror("Error creating raw socket");
         exit(EXIT_FAILURE);
     }
 
     int buffer_size = 4 * 1024 * 1024; // 4 MB
-    if (setsockopt(_socket, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size)) < 0) {
+    if (setsockopt(channel.socket, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size)) < 0) {
         perror("Error setting socket receive buffer size");
     }
 
-    // Configure the network interface for the socket
-    struct ifreq ifr {};
-    std::strncpy(ifr.ifr_name, interface.c_str(), IFNAMSIZ - 1);
-    if (ioctl(_socket, SIOCGIFINDEX, &ifr) < 0) {
-        perror("Error getting interface index");
-        close(_socket);
-        exit(EXIT_FAILURE);
+    // Map the receive ring (the channel falls back to recvfrom if the kernel refuses it)
+    if (enable_receive && _config.receive_mode == ReceiveMode::RING) {
+        setup_ring(channel);
     }
 
-    // Enable asynchronous I/O and set the owner process for SIGIO
-    if (fcntl(_socket, F_SETOWN, getpid()) < 0) {
-        perror("Error setting socket owner");
-        close(_socket);
+    // Attach the kernel filter so that unrelated frames never reach user space
+    default_filter().attach(channel.socket);
+
+    // Bind the socket to the interface so that only its frames are captured
+    struct sockaddr_ll bind_addr {};
+    bind_addr.sll_family   = AF_PACKET;
+    bind_addr.sll_protocol = htons(ETH_P_ALL);
+    bind_addr.sll_ifindex  = ifindex;
+    if (bind(channel.socket, (struct sockaddr*)&bind_addr, sizeof(bind_addr)) < 0) {
+        perror("Error binding raw socket to interface");
+        close(channel.socket);
         exit(EXIT_FAILURE);
     }
-    if (fcntl(_socket, F_SETFL, O_ASYNC | O_NONBLOCK) < 0) {
-        perror("Error enabling asynchronous I/O");
-        close(_socket);
-        exit(EXIT_FAILURE);
+}
+
+// Method to stop receiving on a channel and release its socket and ring
+void Engine::close_channel(Channel& channel) {
+    if (channel.reactor_id != 0) {
+        Reactor::instance().remove(channel.reactor_id);
+        channel.reactor_id = 0;
+    }
+    if (channel.ring != nullptr) {
+        munmap(channel.ring, channel.ring_size);
+        channel.ring = nullptr;
     }
+    if (channel.socket >= 0) {
+        close(channel.socket);
+        channel.socket = -1;
+    }
+}
 
-    // Set up the SIGIO signal handler
-    struct sigaction sa {};
-    sa.sa_handler = &Engine::sigio_handler;
-    sa.sa_flags = 0;
-    sigemptyset(&sa.sa_mask);
-    if (sigaction(SIGIO, &sa, nullptr) < 0) {
-        perror("Error setting up SIGIO handler");
-        close(_socket);
-        exit(EXIT_FAILURE);
+// Method to join every channel in a PACKET_FANOUT group keyed by the sender
+bool Engine::join_fanout() {
+    // The kernel allocates a group id that no other process is using
+    int arg = (PACKET_FANOUT_CBPF | PACKET_FANOUT_FLAG_UNIQUEID) << 16;
+    if (setsockopt(channels[0].socket, SOL_PACKET, PACKET_FANOUT, &arg, sizeof(arg)) < 0) {
+        perror("Error creating PACKET_FANOUT group");
+        return false;
     }
 
-    // Start the receive thread if enabled
-    if (enable_receive) {
-        std::thread recv_thread(&Engine::receive_loop, this);
-        recv_thread.detach();
+    // Program selecting the channel from 4 bytes of the link layer header,
+    // so that every frame of one sender is handled by the same channel
+    struct sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_LL_OFF) + _config.fanout_key_offset),
+        BPF_STMT(BPF_RET | BPF_A, 0),
+    };
+    struct sock_fprog program {};
+    program.len = sizeof(code) / sizeof(code[0]);
+    program.filter = code;
+    if (setsockopt(channels[0].socket, SOL_PACKET, PACKET_FANOUT_DATA, &program, sizeof(program)) < 0) {
+        perror("Error setting PACKET_FANOUT program");
+        return false;
+    }
 
-        // Start the thread to process the queue
-        processing_thread = std::thread(&Engine::process_queue, this);
+    int group = 0;
+    socklen_t length = sizeof(group);
+    if (getsockopt(channels[0].socket, SOL_PACKET, PACKET_FANOUT, &group, &length) < 0) {
+        perror("Error reading PACKET_FANOUT group");
+        return false;
     }
+
+    arg = (group & 0xFFFF) | (PACKET_FANOUT_CBPF << 16);
+    for (size_t i = 1; i < channels.size(); ++i) {
+        if (setsockopt(channels[i].socket, SOL_PACKET, PACKET_FANOUT, &arg, sizeof(arg)) < 0) {
+            perror("Error joining PACKET_FANOUT group");
+            return false;
+        }
+    }
+    return true;
 }
 
 // Destructor
 Engine::~Engine() {
-    if (_socket >= 0) {
-        close(_socket);
+    // Stop receiving before the rings are unmapped and the sockets closed
+    for (Channel& channel : channels) {
+        close_channel(channel);
     }
+}
 
-    // Destroy the semaphore
-    sem_destroy(&receive_semaphore);
-
-    // Finalize the processing thread
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex);
-        stop_processing = true;
+// Method building the kernel filter described by the configuration
+SocketFilter Engine::default_filter() const {
+    SocketFilter filter;
+    filter.accept_broadcast();
+    if (_config.protocol_filter != 0) {
+        filter.accept_protocol(_config.protocol_filter);
     }
-    queue_cv.notify_all();
-    if (processing_thread.joinable()) {
-        processing_thread.join();
+    if (_config.drop_outgoing) {
+        filter.drop_outgoing();
     }
+    return filter;
 }
 
-// Method implementing the Ethernet frame reception loop
-void Engine::receive_loop() {
+// Method to attach (or replace) the kernel filter of every channel
+bool Engine::set_filter(const SocketFilter& filter) {
+    bool attached = true;
+    for (Channel& channel : channels) {
+        attached = filter.attach(channel.socket) && attached;
+    }
+    return attached;
+}
+
+// Method delivering every frame waiting on a channel socket (SOCKET mode)
+void Engine::receive_socket(Channel& channel) {
     constexpr size_t BUFFER_SIZE = 2048;
     char buffer[BUFFER_SIZE];
     const uint8_t broadcast_mac[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
     while (true) {
-        // Wait for the semaphore to be posted
-        sem_wait(&receive_semaphore);
-
-        // Process incoming frames
-        while (true) {
-            ssize_t received_bytes = recvfrom(_socket, buffer, BUFFER_SIZE, 0, nullptr, nullptr);
-
-            if (received_bytes > 0) {
-                // Check if the frame is broadcast
-                if (received_bytes >= 14) { // Ethernet header is at least 14 bytes
-                    const uint8_t* dest_mac = reinterpret_cast<const uint8_t*>(buffer);
-                    if (std::memcmp(dest_mac, broadcast_mac, 6) == 0) {
-                        // The frame is broadcast, add it to the queue
-                        std::vector<char> data(buffer, buffer + received_bytes);
-
-                        {
-                            std::lock_guard<std::mutex> lock(queue_mutex);
-                            buffer_queue.emplace(std::move(data), received_bytes);
-                        }
-                        queue_cv.notify_one();
-                    }
-                }
-            } else if (received_bytes < 0) {
-                // Check if there are no more frames to read
-                if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    break; // No more frames available, break out of the inner loop
-                } else {
-                    //perror("Error receiving Ethernet frame");
-                }
+        ssize_t received_bytes = recvfrom(channel.socket, buffer, BUFFER_SIZE, MSG_DONTWAIT, nullptr, nullptr);
+
+        if (received_bytes > 0) {
+            // Only broadcast frames are delivered (Ethernet header is at least 14 bytes)
+            if (received_bytes >= 14 && std::memcmp(buffer, broadcast_mac, 6) == 0 && _callback) {
+                _callback(buffer, received_bytes);
+            }
+        } else if (received_bytes < 0) {
+            // Check if there are no more frames to read
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else if (errno != EINTR) {
+                //perror("Error receiving Ethernet frame");
+                break;
             }
         }
     }
 }
 
-// Method to process the buffer queue
-void Engine::process_queue() {
-    while (true) {
-        std::pair<std::vector<char>, size_t> item;
+// Method to configure the TPACKET_V3 receive ring of a channel and map it into the process
+bool Engine::setup_ring(Channel& channel) {
+    int version = TPACKET_V3;
+    if (setsockopt(channel.socket, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+        perror("Error setting TPACKET_V3");
+        return false;
+    }
 
-        // Wait until there is an item in the queue or processing needs to stop
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            queue_cv.wait(lock, [this]() { return !buffer_queue.empty() || stop_processing; });
+    struct tpacket_req3 req {};
+    req.tp_block_size = _config.ring_block_size;
+    req.tp_block_nr = _config.ring_block_count;
+    req.tp_frame_size = _config.ring_frame_size;
+    req.tp_frame_nr = (_config.ring_block_size / _config.ring_frame_size) * _config.ring_block_count;
+    req.tp_retire_blk_tov = _config.ring_block_timeout_ms;
+    if (setsockopt(channel.socket, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0) {
+        perror("Error creating PACKET_RX_RING");
+        return false;
+    }
 
-            if (stop_processing && buffer_queue.empty()) {
-                break;
-            }
+    channel.ring_size = static_cast<size_t>(req.tp_block_size) * req.tp_block_nr;
+    void* ring = mmap(nullptr, channel.ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, channel.socket, 0);
+    if (ring == MAP_FAILED) {
+        // MAP_LOCKED may exceed RLIMIT_MEMLOCK, retry without it
+        ring = mmap(nullptr, channel.ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, channel.socket, 0);
+    }
+    if (ring == MAP_FAILED) {
+        perror("Error mapping PACKET_RX_RING");
+        channel.ring_size = 0;
+        return false;
+    }
+    channel.ring = static_cast<uint8_t*>(ring);
+    return true;
+}
+
+// Method delivering every block the kernel has handed over to a channel (RING mode)
+void Engine::receive_ring(Channel& channel) {
+    const uint8_t broadcast_mac[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+    while (true) {
+        auto* desc = reinterpret_cast<struct tpacket_block_desc*>(channel.ring + static_cast<size_t>(channel.ring_block) * _config.ring_block_size);
 
-            item = std::move(buffer_queue.front());
-            buffer_queue.pop();
+        // Stop at the first block still owned by the kernel; the reactor wakes us again
+        if ((__atomic_load_n(&desc->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) {
+            break;
         }
 
-        // Process the item using the callback
-        if (_callback) {
-            _callback(item.first.data(), item.second);
+        // Walk every frame of the block, delivering it without copying
+        uint32_t num_pkts = desc->hdr.bh1.num_pkts;
+        auto* hdr = reinterpret_cast<struct tpacket3_hdr*>(reinterpret_cast<uint8_t*>(desc) + desc->hdr.bh1.offset_to_first_pkt);
+        for (uint32_t i = 0; i < num_pkts; ++i) {
+            const uint8_t* frame = reinterpret_cast<const uint8_t*>(hdr) + hdr->tp_mac;
+            size_t length = hdr->tp_snaplen;
+
+            // Only broadcast frames are delivered (same rule as SOCKET mode)
+            if (length >= 14 && std::memcmp(frame, broadcast_mac, 6) == 0 && _callback) {
+                _callback(frame, length);
+            }
+            hdr = reinterpret_cast<struct tpacket3_hdr*>(reinterpret_cast<uint8_t*>(hdr) + hdr->tp_next_offset);
         }
+
+        // Return the block to the kernel
+        __atomic_store_n(&desc->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        channel.ring_block = (channel.ring_block + 1) % _config.ring_block_count;
     }
 }
 
-// Method to send an Ethernet frame
+// Method to send an Ethernet frame (queued while a batch is open)
 int Engine::send(const void* data, size_t size) {
-    struct sockaddr_ll dest_addr {};
-    struct ifreq ifr {};
-    std::strncpy(ifr.ifr_name, _interface.c_str(), IFNAMSIZ - 1);
-
-    // Get the network interface index
-    if (ioctl(_socket, SIOCGIFINDEX, &ifr) < 0) {
-        perror("ioctl SIOCGIFINDEX");
-        return -1;
+    std::unique_lock<std::mutex> lock(tx_mutex);
+
+    if (tx_batch_depth > 0 && size <= TX_SLOT_SIZE) {
+        // Copy the frame into the next slot and flush once the queue is full
+        std::memcpy(tx_iov[tx_count].iov_base, data, size);
+        tx_iov[tx_count].iov_len = size;
+        tx_count++;
+        if (tx_count == _config.tx_batch_size) {
+            flush_locked();
+        }
+        return static_cast<int>(size);
     }
 
-    // Configure the destination address for the Ethernet frame
-    dest_addr.sll_family   = AF_PACKET;
-    dest_addr.sll_ifindex  = ifr.ifr_ifindex;
-    dest_addr.sll_protocol = htons(ETH_P_ALL);
-    dest_addr.sll_halen    = ETH_ALEN;
-
-    // Set the broadcast MAC address as the destination
-    std::memset(dest_addr.sll_addr, 0xFF, 6);
-
-    // Temporarily set the socket to blocking mode
-    int flags = fcntl(_socket, F_GETFL, 0);
-    fcntl(_socket, F_SETFL, flags & ~O_NONBLOCK);
-
-    // Perform the send operation
-    int sent_bytes = ::sendto(_socket, data, size, 0, (struct sockaddr*)&dest_addr, sizeof(dest_addr));
-
-    // Restore the socket to non-blocking mode
-    fcntl(_socket, F_SETFL, flags | O_NONBLOCK);
+    // Keep ordering with any frame still queued before sending directly
+    if (tx_count > 0) {
+        flush_locked();
+    }
+    lock.unlock();
+    return send_now(data, size);
+}
 
+// Method to send a single Ethernet frame immediately
+int Engine::send_now(const void* data, size_t size) {
+    int sent_bytes = ::sendto(_socket, data, size, 0, (struct sockaddr*)&_dest_addr, sizeof(_dest_addr));
     if (sent_bytes < 0) {
         perror("Error sending Ethernet frame");
         return -1;
     }
     return sent_bytes;
 }
+
+// Method to open a transmit batch
+void Engine::begin_batch() {
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    tx_batch_depth++;
+}
+
+// Method to close a transmit batch, flushing the queue when the outermost one ends
+int Engine::end_batch() {
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    if (tx_batch_depth > 0) {
+        tx_batch_depth--;
+    }
+    return (tx_batch_depth == 0) ? flush_locked() : 0;
+}
+
+// Method to send every queued frame
+int Engine::flush() {
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    return flush_locked();
+}
+
+// Method to send every queued frame with sendmmsg (tx_mutex must be held)
+int Engine::flush_locked() {
+    size_t sent = 0;
+    while (sent < tx_count) {
+        int result = sendmmsg(_socket, &tx_msgs[sent], tx_count - sent, 0);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("Error sending Ethernet frame batch");
+            break;
+        }
+        sent += result;
+    }
+    tx_count = 0;
+    return static_cast<int>(sent);
+}
@@ -0,0 +1,81 @@
+#include "../include/executor.hpp"
+
+#include <algorithm>
+
+// Executor whose pool runs the current thread (nullptr outside every pool)
+static thread_local const Executor* current_executor = nullptr;
+
+// Constructor; the pool is started with the first task
+Executor::Executor(unsigned int threads)
+    : thread_count(std::max(1u, threads)) {}
+
+// Destructor: the pool finishes the queued tasks (and those they post) before stopping
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// Method to resize the pool before it starts
+bool Executor::set_thread_count(unsigned int threads) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!this->threads.empty()) {
+        return false;
+    }
+    thread_count = std::max(1u, threads);
+    return true;
+}
+
+// Method to queue a task
+void Executor::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+        stats.high_water = std::max(stats.high_water, tasks.size());
+        if (threads.empty()) {
+            for (unsigned int i = 0; i < thread_count; ++i) {
+                threads.emplace_back(&Executor::run, this);
+            }
+            stats.threads = thread_count;
+        }
+    }
+    wake.notify_one();
+}
+
+// Method run by each pool thread
+void Executor::run() {
+    current_executor = this;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        if (tasks.empty()) {
+            if (stopping) {
+                return;
+            }
+            wake.wait(lock);
+            continue;
+        }
+        Task task = std::move(tasks.front());
+        tasks.pop_front();
+        lock.unlock();
+        task();
+        task = nullptr;   // Releases what the task captured outside the lock
+        lock.lock();
+        stats.tasks_run++;
+    }
+}
+
+// Method telling whether the caller is a pool thread of this executor
+bool Executor::in_pool() const {
+    return current_executor == this;
+}
+
+// Method returning the counters of the pool
+Executor::Statistics Executor::statistics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
@@ -1,33 +1,63 @@
 #include "../include/internal_engine.hpp"
 #include <iostream>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
-#include <queue>
-#include <vector>
+#include <cstring>
+#include <climits>
+#include <ctime>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// Slot header, followed by slot_size bytes of frame data.
+// 'sequence' equals the position when the slot is free for that position,
+// position + 1 once its frame is published and position + slot_count once
+// the frame was consumed (the slot is then free for the next lap).
+struct InternalEngine::Slot {
+    uint64_t sequence;
+    uint32_t size;
+    uint32_t reserved;
+};
+
+static int futex(uint32_t* address, int operation, uint32_t value, const struct timespec* timeout) {
+    return static_cast<int>(syscall(SYS_futex, address, operation, value, timeout, nullptr, 0));
+}
 
 // Constructor for InternalEngine
 InternalEngine::InternalEngine(Callback callback)
-    : _callback(callback), stop_processing(false) {
-    // Start the processing thread
-    processing_thread = std::thread(&InternalEngine::process_queue, this);
-}
+    : InternalEngine("", callback, true, Config()) {}
 
 // Constructor for InternalEngine (new signature)
 InternalEngine::InternalEngine(const std::string& interface, Callback callback, bool flag)
-    : _callback(callback), stop_processing(false) {
+    : InternalEngine(interface, callback, flag, Config()) {}
+
+// Constructor with explicit configuration
+InternalEngine::InternalEngine(const std::string& interface, Callback callback, bool flag, const Config& config)
+    : _callback(callback), _config(config) {
     // The `interface` and `flag` arguments are accepted but not used
+    unsigned int count = 1;
+    while (count < _config.slot_count) {
+        count <<= 1;
+    }
+    _config.slot_count = count;
+
+    // Every slot starts free for the position of the first lap
+    slot_stride = (sizeof(Slot) + _config.slot_size + 63) & ~static_cast<size_t>(63);
+    slots.reset(new uint8_t[count * slot_stride]);
+    for (uint64_t position = 0; position < count; ++position) {
+        slot(position)->sequence = position;
+    }
+
     processing_thread = std::thread(&InternalEngine::process_queue, this);
 }
 
 // Destructor for InternalEngine
 InternalEngine::~InternalEngine() {
-    // Signal the processing thread to stop
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex);
-        stop_processing = true;
-    }
-    queue_cv.notify_all();
+    // Signal the processing thread and blocked senders to stop
+    stop_processing = true;
+    __atomic_fetch_add(&items, 1, __ATOMIC_SEQ_CST);
+    futex(&items, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
+    __atomic_fetch_add(&space, 1, __ATOMIC_SEQ_CST);
+    futex(&space, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
 
     // Join the processing thread
     if (processing_thread.joinable()) {
@@ -35,39 +65,170 @@ InternalEngine::~InternalEngine() {
     }
 }
 
-// Method to add data to the queue
-int InternalEngine::send(const void* data, size_t size) {
-    std::vector<char> buffer(static_cast<const char*>(data), static_cast<const char*>(data) + size);
+// Method returning the slot of a position
+InternalEngine::Slot* InternalEngine::slot(uint64_t position) const {
+    return reinterpret_cast<Slot*>(slots.get() + (position & (_config.slot_count - 1)) * slot_stride);
+}
 
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex);
-        buffer_queue.emplace(std::move(buffer), size);
+// Method to claim the next free slot and publish a frame in it; returns false if the ring is full
+bool InternalEngine::try_enqueue(const void* data, size_t size) {
+    uint64_t position = __atomic_load_n(&enqueue_position, __ATOMIC_RELAXED);
+    Slot* s;
+    while (true) {
+        s = slot(position);
+        uint64_t sequence = __atomic_load_n(&s->sequence, __ATOMIC_ACQUIRE);
+        int64_t difference = static_cast<int64_t>(sequence - position);
+        if (difference == 0) {
+            if (__atomic_compare_exchange_n(&enqueue_position, &position, position + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (difference < 0) {
+            return false;  // Still holds the frame of the previous lap
+        } else {
+            position = __atomic_load_n(&enqueue_position, __ATOMIC_RELAXED);
+        }
     }
-    queue_cv.notify_one();
-    return 1; // Return 1 to indicate success
+
+    s->size = static_cast<uint32_t>(size);
+    std::memcpy(reinterpret_cast<uint8_t*>(s) + sizeof(Slot), data, size);
+    __atomic_store_n(&s->sequence, position + 1, __ATOMIC_RELEASE);
+    return true;
 }
 
-// Method to process the queue
-void InternalEngine::process_queue() {
+// Method to discard the oldest published frame; returns false if there was none to discard
+bool InternalEngine::discard_oldest() {
+    uint64_t position = __atomic_load_n(&dequeue_position, __ATOMIC_RELAXED);
     while (true) {
-        std::pair<std::vector<char>, size_t> item;
+        Slot* s = slot(position);
+        uint64_t sequence = __atomic_load_n(&s->sequence, __ATOMIC_ACQUIRE);
+        int64_t difference = static_cast<int64_t>(sequence - (position + 1));
+        if (difference == 0) {
+            if (__atomic_compare_exchange_n(&dequeue_position, &position, position + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                __atomic_store_n(&s->sequence, position + _config.slot_count, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false;  // Not published yet (or being delivered)
+        } else {
+            position = __atomic_load_n(&dequeue_position, __ATOMIC_RELAXED);
+        }
+    }
+}
 
-        // Wait until there is data in the queue or stop_processing is true
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            queue_cv.wait(lock, [this]() { return !buffer_queue.empty() || stop_processing; });
+// Method to add data to the queue
+int InternalEngine::send(const void* data, size_t size) {
+    if (size > _config.slot_size) {
+        std::cerr << "Error sending internal frame: " << size << " bytes exceed the ring slot size" << std::endl;
+        return -1;
+    }
 
-            if (stop_processing && buffer_queue.empty()) {
-                break;
+    while (!try_enqueue(data, size)) {
+        if (stop_processing) {
+            return -1;
+        }
+        if (_config.overflow == Overflow::DROP_NEWEST) {
+            frames_dropped.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        }
+        if (_config.overflow == Overflow::DROP_OLDEST) {
+            if (discard_oldest()) {
+                frames_overwritten.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                sched_yield();  // The oldest frame is still being written or delivered
             }
+            continue;
+        }
+
+        // BLOCK: sleep until the processing thread frees a slot
+        // (the 10 ms timeout only bounds the wait, wakeups are not lost)
+        const struct timespec timeout {0, 10 * 1000 * 1000};
+        __atomic_fetch_add(&space_waiters, 1, __ATOMIC_SEQ_CST);
+        uint32_t seen = __atomic_load_n(&space, __ATOMIC_SEQ_CST);
+        bool queued = try_enqueue(data, size);
+        if (!queued && !stop_processing) {
+            sender_waits.fetch_add(1, std::memory_order_relaxed);
+            futex(&space, FUTEX_WAIT_PRIVATE, seen, &timeout);
+        }
+        __atomic_fetch_sub(&space_waiters, 1, __ATOMIC_SEQ_CST);
+        if (queued) {
+            break;
+        }
+    }
+    frames_sent.fetch_add(1, std::memory_order_relaxed);
+
+    // Wake the processing thread only if it is asleep
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&consumer_waiting, __ATOMIC_RELAXED) != 0) {
+        __atomic_fetch_add(&items, 1, __ATOMIC_SEQ_CST);
+        futex(&items, FUTEX_WAKE_PRIVATE, 1, nullptr);
+    }
+    return static_cast<int>(size);
+}
 
-            item = std::move(buffer_queue.front());
-            buffer_queue.pop();
+// Method delivering every published frame to the callback; returns false if there was none
+bool InternalEngine::deliver_pending() {
+    bool progress = false;
+    while (true) {
+        uint64_t position = __atomic_load_n(&dequeue_position, __ATOMIC_RELAXED);
+        Slot* s = slot(position);
+        uint64_t sequence = __atomic_load_n(&s->sequence, __ATOMIC_ACQUIRE);
+        int64_t difference = static_cast<int64_t>(sequence - (position + 1));
+        if (difference < 0) {
+            break;  // Empty
+        }
+        // A sender may have discarded this frame (DROP_OLDEST) in the meantime
+        if (difference > 0 || !__atomic_compare_exchange_n(&dequeue_position, &position, position + 1, false,
+                                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            continue;
         }
 
-        // Process the item using the callback
+        // Process the frame in place, then hand the slot back to the senders
         if (_callback) {
-            _callback(item.first.data(), item.second);
+            _callback(reinterpret_cast<uint8_t*>(s) + sizeof(Slot), s->size);
+        }
+        __atomic_store_n(&s->sequence, position + _config.slot_count, __ATOMIC_RELEASE);
+        frames_delivered.fetch_add(1, std::memory_order_relaxed);
+        progress = true;
+
+        // Wake senders blocked on a full ring
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&space_waiters, __ATOMIC_RELAXED) != 0) {
+            __atomic_fetch_add(&space, 1, __ATOMIC_SEQ_CST);
+            futex(&space, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
+        }
+    }
+    return progress;
+}
+
+// Method to process the queue
+void InternalEngine::process_queue() {
+    while (true) {
+        if (deliver_pending()) {
+            continue;
+        }
+        if (stop_processing) {
+            break;
+        }
+
+        // Announce the sleep, then look again so that a frame published meanwhile is not missed
+        uint32_t seen = __atomic_load_n(&items, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&consumer_waiting, 1, __ATOMIC_SEQ_CST);
+        if (!deliver_pending() && !stop_processing) {
+            futex(&items, FUTEX_WAIT_PRIVATE, seen, nullptr);
         }
+        __atomic_store_n(&consumer_waiting, 0, __ATOMIC_RELAXED);
     }
-}
\ No newline at end of file
+}
+
+// Method returning the counters of the engine
+InternalEngine::Statistics InternalEngine::statistics() const {
+    Statistics stats;
+    stats.frames_sent = frames_sent;
+    stats.frames_delivered = frames_delivered;
+    stats.frames_dropped = frames_dropped;
+    stats.frames_overwritten = frames_overwritten;
+    stats.sender_waits = sender_waits;
+    return stats;
+}
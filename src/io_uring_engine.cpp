@@ -0,0 +1,470 @@
+#include "../include/io_uring_engine.hpp"
+#include "../include/reactor.hpp"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+#include <unistd.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+
+// There is no liburing in the build, so the rings are driven with the raw syscalls
+static int sys_io_uring_setup(unsigned int entries, struct io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int sys_io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int sys_io_uring_register(int fd, unsigned int opcode, void* arg, unsigned int nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+// Constructor
+IoUringEngine::IoUringEngine(const std::string& interface, Callback callback, bool enable_receive)
+    : IoUringEngine(interface, callback, enable_receive, Config()) {}
+
+// Constructor with explicit configuration
+IoUringEngine::IoUringEngine(const std::string& interface, Callback callback, bool enable_receive, const Config& config)
+    : _interface(interface), _callback(callback), _config(config) {
+    int ifindex = static_cast<int>(if_nametoindex(interface.c_str()));
+    if (ifindex == 0) {
+        perror("Error getting interface index");
+        exit(EXIT_FAILURE);
+    }
+
+    // Create a raw socket to capture Ethernet packets
+    _socket = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (_socket < 0) {
+        perror("Error creating raw socket");
+        exit(EXIT_FAILURE);
+    }
+
+    int buffer_size = 4 * 1024 * 1024; // 4 MB
+    if (setsockopt(_socket, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size)) < 0) {
+        perror("Error setting socket receive buffer size");
+    }
+
+    // Attach the kernel filter so that unrelated frames never reach user space
+    default_filter().attach(_socket);
+
+    struct sockaddr_ll bind_addr {};
+    bind_addr.sll_family   = AF_PACKET;
+    bind_addr.sll_protocol = htons(ETH_P_ALL);
+    bind_addr.sll_ifindex  = ifindex;
+    if (bind(_socket, (struct sockaddr*)&bind_addr, sizeof(bind_addr)) < 0) {
+        perror("Error binding raw socket to interface");
+        close(_socket);
+        exit(EXIT_FAILURE);
+    }
+
+    // Send ring with one preallocated buffer and message header per slot
+    if (!setup_ring(tx, _config.tx_slots)) {
+        exit(EXIT_FAILURE);
+    }
+    _dest_addr = {};
+    _dest_addr.sll_family   = AF_PACKET;
+    _dest_addr.sll_ifindex  = ifindex;
+    _dest_addr.sll_protocol = htons(ETH_P_ALL);
+    _dest_addr.sll_halen    = ETH_ALEN;
+    std::memset(_dest_addr.sll_addr, 0xFF, 6);
+
+    tx_buffers.resize(static_cast<size_t>(_config.tx_slots) * TX_SLOT_SIZE);
+    tx_iov.resize(_config.tx_slots);
+    tx_msgs.resize(_config.tx_slots);
+    for (uint32_t i = 0; i < _config.tx_slots; ++i) {
+        tx_iov[i].iov_base = &tx_buffers[static_cast<size_t>(i) * TX_SLOT_SIZE];
+        tx_msgs[i] = {};
+        tx_msgs[i].msg_name = &_dest_addr;
+        tx_msgs[i].msg_namelen = sizeof(_dest_addr);
+        tx_msgs[i].msg_iov = &tx_iov[i];
+        tx_msgs[i].msg_iovlen = 1;
+        tx_free.push_back(_config.tx_slots - 1 - i);
+    }
+
+    // Receive ring: completions are processed by the shared reactor
+    if (enable_receive) {
+        if (!setup_receive()) {
+            exit(EXIT_FAILURE);
+        }
+        post_receive();
+        Reactor::reserve_threads(1);
+        _reactor_id = Reactor::instance().add(rx.fd, [this]() { receive_completions(); });
+    }
+}
+
+// Destructor
+IoUringEngine::~IoUringEngine() {
+    // Stop processing completions before the rings and buffers go away
+    if (_reactor_id != 0) {
+        Reactor::instance().remove(_reactor_id);
+    }
+    {
+        std::lock_guard<std::mutex> lock(tx_mutex);
+        flush_locked();
+    }
+    close_ring(rx);
+    close_ring(tx);
+    if (_socket >= 0) {
+        close(_socket);
+    }
+    if (buf_ring != nullptr) {
+        munmap(buf_ring, buf_ring_size);
+    }
+    if (buffers != nullptr) {
+        munmap(buffers, buffers_size);
+    }
+}
+
+// Method to create an io_uring instance and map its queues
+bool IoUringEngine::setup_ring(Ring& ring, unsigned int entries, unsigned int cq_entries) {
+    struct io_uring_params params {};
+    if (cq_entries > 0) {
+        params.flags |= IORING_SETUP_CQSIZE;
+        params.cq_entries = cq_entries;
+    }
+    ring.fd = sys_io_uring_setup(entries, &params);
+    if (ring.fd < 0) {
+        perror("Error creating io_uring");
+        return false;
+    }
+
+    ring.sq_map_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring.cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        ring.sq_map_size = ring.cq_map_size = std::max(ring.sq_map_size, ring.cq_map_size);
+    }
+
+    ring.sq_map = mmap(nullptr, ring.sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+    if (ring.sq_map == MAP_FAILED) {
+        ring.sq_map = nullptr;
+        perror("Error mapping io_uring submission queue");
+        return false;
+    }
+    if (single_mmap) {
+        ring.cq_map = ring.sq_map;
+    } else {
+        ring.cq_map = mmap(nullptr, ring.cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+        if (ring.cq_map == MAP_FAILED) {
+            ring.cq_map = nullptr;
+            perror("Error mapping io_uring completion queue");
+            return false;
+        }
+    }
+    ring.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, ring.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        perror("Error mapping io_uring submission entries");
+        return false;
+    }
+    ring.sqes = static_cast<struct io_uring_sqe*>(sqes);
+
+    uint8_t* sq = static_cast<uint8_t*>(ring.sq_map);
+    ring.sq_head = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+    ring.sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    ring.sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    ring.sq_entries = params.sq_entries;
+    ring.sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+    ring.sq_flags = reinterpret_cast<uint32_t*>(sq + params.sq_off.flags);
+
+    uint8_t* cq = static_cast<uint8_t*>(ring.cq_map);
+    ring.cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    ring.cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    ring.cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    ring.cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+}
+
+// Method to release an io_uring instance (pending requests are cancelled)
+void IoUringEngine::close_ring(Ring& ring) {
+    if (ring.sqes != nullptr) {
+        munmap(ring.sqes, ring.sqes_size);
+        ring.sqes = nullptr;
+    }
+    if (ring.cq_map != nullptr && ring.cq_map != ring.sq_map) {
+        munmap(ring.cq_map, ring.cq_map_size);
+    }
+    ring.cq_map = nullptr;
+    if (ring.sq_map != nullptr) {
+        munmap(ring.sq_map, ring.sq_map_size);
+        ring.sq_map = nullptr;
+    }
+    if (ring.fd >= 0) {
+        close(ring.fd);
+        ring.fd = -1;
+    }
+}
+
+// Method returning the next free submission entry (nullptr if the queue is full)
+struct io_uring_sqe* IoUringEngine::get_sqe(Ring& ring) {
+    uint32_t head = __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE);
+    uint32_t tail = *ring.sq_tail;
+    if (tail - head >= ring.sq_entries) {
+        return nullptr;
+    }
+    uint32_t index = tail & ring.sq_mask;
+    struct io_uring_sqe* sqe = &ring.sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    ring.sq_array[index] = index;
+    return sqe;
+}
+
+// Method submitting the queued entries, optionally waiting for 'wait' completions
+int IoUringEngine::submit(Ring& ring, unsigned int wait) {
+    while (true) {
+        int result = sys_io_uring_enter(ring.fd, ring.to_submit, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0);
+        if (result >= 0) {
+            ring.to_submit -= std::min<uint32_t>(ring.to_submit, static_cast<uint32_t>(result));
+            return result;
+        }
+        if (errno != EINTR) {
+            perror("Error submitting io_uring requests");
+            return -1;
+        }
+    }
+}
+
+// Method to register the provided buffer ring used by the multishot receive
+bool IoUringEngine::setup_receive() {
+    // One multishot request, but room in the completion queue for every buffer
+    if (!setup_ring(rx, 8, _config.buffer_count)) {
+        return false;
+    }
+
+    buffers_size = static_cast<size_t>(_config.buffer_count) * _config.buffer_size;
+    void* area = mmap(nullptr, buffers_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (area == MAP_FAILED) {
+        perror("Error allocating receive buffers");
+        return false;
+    }
+    buffers = static_cast<uint8_t*>(area);
+
+    // The buffer ring must be page aligned, which mmap guarantees
+    buf_ring_size = _config.buffer_count * sizeof(struct io_uring_buf);
+    area = mmap(nullptr, buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (area == MAP_FAILED) {
+        perror("Error allocating provided buffer ring");
+        return false;
+    }
+    buf_ring = static_cast<struct io_uring_buf_ring*>(area);
+
+    struct io_uring_buf_reg reg {};
+    reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring);
+    reg.ring_entries = _config.buffer_count;
+    reg.bgid = BUFFER_GROUP;
+    if (sys_io_uring_register(rx.fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        perror("Error registering provided buffer ring");
+        return false;
+    }
+
+    // The entries are addressed through a plain pointer: in C++ the flexible
+    // 'bufs' member of io_uring_buf_ring is not at offset 0
+    auto* bufs = reinterpret_cast<struct io_uring_buf*>(buf_ring);
+    for (uint32_t i = 0; i < _config.buffer_count; ++i) {
+        struct io_uring_buf& buf = bufs[i];
+        buf.addr = reinterpret_cast<uint64_t>(buffers + static_cast<size_t>(i) * _config.buffer_size);
+        buf.len = _config.buffer_size;
+        buf.bid = static_cast<uint16_t>(i);
+    }
+    __atomic_store_n(&buf_ring->tail, static_cast<uint16_t>(_config.buffer_count), __ATOMIC_RELEASE);
+    return true;
+}
+
+// Method posting the multishot recvmsg that keeps delivering frames until it is cancelled or runs out of buffers
+void IoUringEngine::post_receive() {
+    struct io_uring_sqe* sqe = get_sqe(rx);
+    if (sqe == nullptr) {
+        std::cerr << "Error posting io_uring receive: submission queue full" << std::endl;
+        return;
+    }
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = _socket;
+    sqe->addr = reinterpret_cast<uint64_t>(&recv_msg);
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = RECV_TAG;
+    __atomic_store_n(rx.sq_tail, *rx.sq_tail + 1, __ATOMIC_RELEASE);
+    rx.to_submit++;
+    submit(rx, 0);
+}
+
+// Method handing a receive buffer back to the kernel
+void IoUringEngine::recycle_buffer(uint16_t id) {
+    uint16_t tail = buf_ring->tail;
+    struct io_uring_buf& buf = reinterpret_cast<struct io_uring_buf*>(buf_ring)[tail & (_config.buffer_count - 1)];
+    buf.addr = reinterpret_cast<uint64_t>(buffers + static_cast<size_t>(id) * _config.buffer_size);
+    buf.len = _config.buffer_size;
+    buf.bid = id;
+    __atomic_store_n(&buf_ring->tail, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+}
+
+// Method delivering every frame completed by the multishot receive
+void IoUringEngine::receive_completions() {
+    const uint8_t broadcast_mac[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    bool rearm = false;
+
+    while (true) {
+        uint32_t head = *rx.cq_head;
+        uint32_t tail = __atomic_load_n(rx.cq_tail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            break;
+        }
+
+        for (; head != tail; ++head) {
+            const struct io_uring_cqe& cqe = rx.cqes[head & rx.cq_mask];
+            if (cqe.user_data != RECV_TAG) {
+                continue;
+            }
+
+            if (cqe.flags & IORING_CQE_F_BUFFER) {
+                uint16_t id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                uint8_t* buffer = buffers + static_cast<size_t>(id) * _config.buffer_size;
+
+                // Buffer layout: io_uring_recvmsg_out, name, control data, then the frame
+                if (cqe.res > 0) {
+                    auto* out = reinterpret_cast<struct io_uring_recvmsg_out*>(buffer);
+                    size_t offset = sizeof(*out) + recv_msg.msg_namelen + recv_msg.msg_controllen;
+                    size_t length = std::min<size_t>(out->payloadlen, static_cast<size_t>(cqe.res) - offset);
+                    const uint8_t* frame = buffer + offset;
+
+                    // Only broadcast frames are delivered (same rule as Engine)
+                    if (length >= 14 && std::memcmp(frame, broadcast_mac, 6) == 0 && _callback) {
+                        _callback(frame, length);
+                    }
+                }
+                recycle_buffer(id);
+            }
+
+            // The kernel ends the multishot request when it runs out of buffers (or on error)
+            if ((cqe.flags & IORING_CQE_F_MORE) == 0) {
+                if (cqe.res < 0 && cqe.res != -ENOBUFS) {
+                    std::cerr << "Error receiving Ethernet frame: " << strerror(-cqe.res) << std::endl;
+                } else {
+                    rearm = true;
+                }
+            }
+        }
+        __atomic_store_n(rx.cq_head, head, __ATOMIC_RELEASE);
+
+        // Completions that did not fit in the queue are flushed by entering the kernel
+        if (__atomic_load_n(rx.sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW) {
+            sys_io_uring_enter(rx.fd, 0, 0, IORING_ENTER_GETEVENTS);
+        }
+    }
+
+    if (rearm) {
+        post_receive();
+    }
+}
+
+// Method returning the slots of completed sends (tx_mutex must be held)
+void IoUringEngine::reap_sends() {
+    uint32_t head = *tx.cq_head;
+    uint32_t tail = __atomic_load_n(tx.cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        const struct io_uring_cqe& cqe = tx.cqes[head & tx.cq_mask];
+        if (cqe.res < 0) {
+            std::cerr << "Error sending Ethernet frame: " << strerror(-cqe.res) << std::endl;
+        }
+        tx_free.push_back(static_cast<uint32_t>(cqe.user_data));
+    }
+    __atomic_store_n(tx.cq_head, head, __ATOMIC_RELEASE);
+}
+
+// Method to send an Ethernet frame (submitted at once unless a batch is open)
+int IoUringEngine::send(const void* data, size_t size) {
+    if (size > TX_SLOT_SIZE) {
+        std::cerr << "Error sending Ethernet frame: " << size << " bytes exceed the send slot size" << std::endl;
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    reap_sends();
+    if (tx_free.empty()) {
+        // Every slot is in flight: submit what is queued and wait for one completion
+        if (submit(tx, 1) < 0) {
+            return -1;
+        }
+        reap_sends();
+    }
+
+    uint32_t slot = tx_free.back();
+    struct io_uring_sqe* sqe = get_sqe(tx);
+    if (sqe == nullptr) {
+        std::cerr << "Error sending Ethernet frame: submission queue full" << std::endl;
+        return -1;
+    }
+    tx_free.pop_back();
+
+    std::memcpy(tx_iov[slot].iov_base, data, size);
+    tx_iov[slot].iov_len = size;
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = _socket;
+    sqe->addr = reinterpret_cast<uint64_t>(&tx_msgs[slot]);
+    sqe->len = 1;
+    sqe->user_data = slot;
+    __atomic_store_n(tx.sq_tail, *tx.sq_tail + 1, __ATOMIC_RELEASE);
+    tx.to_submit++;
+
+    if (tx_batch_depth == 0 || tx.to_submit == tx.sq_entries) {
+        if (submit(tx, 0) < 0) {
+            return -1;
+        }
+    }
+    return static_cast<int>(size);
+}
+
+// Method to open a transmit batch
+void IoUringEngine::begin_batch() {
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    tx_batch_depth++;
+}
+
+// Method to close a transmit batch, submitting the queue when the outermost one ends
+int IoUringEngine::end_batch() {
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    if (tx_batch_depth > 0) {
+        tx_batch_depth--;
+    }
+    return (tx_batch_depth == 0) ? flush_locked() : 0;
+}
+
+// Method to submit every queued send
+int IoUringEngine::flush() {
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    return flush_locked();
+}
+
+// Method to submit every queued send (tx_mutex must be held)
+int IoUringEngine::flush_locked() {
+    if (tx.to_submit == 0) {
+        return 0;
+    }
+    return submit(tx, 0);
+}
+
+// Method building the kernel filter described by the configuration
+SocketFilter IoUringEngine::default_filter() const {
+    SocketFilter filter;
+    filter.accept_broadcast();
+    if (_config.protocol_filter != 0) {
+        filter.accept_protocol(_config.protocol_filter);
+    }
+    if (_config.drop_outgoing) {
+        filter.drop_outgoing();
+    }
+    return filter;
+}
+
+// Method to attach (or replace) the kernel filter
+bool IoUringEngine::set_filter(const SocketFilter& filter) {
+    return filter.attach(_socket);
+}
@@ -3,55 +3,96 @@
 #include "../include/observer.hpp"
 
 #include <iostream>
+#include <cstring>
 #include <unistd.h>
+#include <mutex>
+#include <random>
+#include <new>
 
 
 typedef Ethernet::Mac_Address Mac_Address;
 
 // Definições para o Buffer
-template <typename Engine>
-NIC<Engine>::Buffer::Buffer() : size(0) {}
+NIC_Base::Buffer::Buffer() : size(0) {}
 
-template <typename Engine>
-NIC<Engine>::Buffer::Buffer(const Frame& f, size_t s) : frame(f), size(s) {}
+NIC_Base::Buffer::Buffer(const Frame& f, size_t s) : frame(f), size(s) {}
+
+// Devolve o buffer à NIC que o recebeu quando não há mais referências à mensagem
+void NIC_Base::Buffer::recycle() {
+    owner->free(this);
+}
+
+// O buffer é escasso quando o pool da NIC só tem a reserva de envio
+bool NIC_Base::Buffer::scarce() const {
+    return owner != nullptr && owner->buffer_pool.low();
+}
+
+// Construtor da parte comum das NICs com o pool de buffers padrão
+NIC_Base::NIC_Base() : NIC_Base(BufferPool::Config()) {}
+
+// Construtor da parte comum das NICs: cria o pool de buffers e gera o endereço MAC da interface
+NIC_Base::NIC_Base(const BufferPool::Config& pool_config) : buffer_pool(sizeof(Buffer), pool_config) {
+    // Gerador compartilhado pelas NICs do processo, para que NICs do mesmo processo
+    // tenham MACs distintos. É semeado novamente com o PID após um fork, senão
+    // os processos filhos repetiriam a mesma sequência.
+    static std::mutex mutex;
+    static std::mt19937 generator;
+    static pid_t seeded_pid = 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (seeded_pid != getpid()) {
+        seeded_pid = getpid();
+        generator.seed(std::random_device{}() ^ static_cast<unsigned int>(seeded_pid));
+    }
+    // Generate a random MAC address
+    for (auto& byte : mac_address) {
+        byte = static_cast<uint8_t>(generator() % 256);
+    }
+}
 
 // Construtor da classe NIC
 template <typename Engine>
 NIC<Engine>::NIC(const std::string& interface)
-    : engine(std::make_unique<Engine>(interface, [this](const void* data, size_t size) {
+    : NIC(interface, typename Engine::Config()) {}
+
+// Construtor da classe NIC com configuração explícita da Engine
+template <typename Engine>
+NIC<Engine>::NIC(const std::string& interface, const typename Engine::Config& config)
+    : NIC(interface, config, BufferPool::Config()) {}
+
+// Construtor da classe NIC com configuração explícita da Engine, do pool de buffers e da InternalEngine
+template <typename Engine>
+NIC<Engine>::NIC(const std::string& interface, const typename Engine::Config& config, const BufferPool::Config& pool_config,
+                 const InternalEngine::Config& internal_config)
+    : NIC_Base(pool_config),
+      engine(std::make_unique<Engine>(interface, [this](const void* data, size_t size) {
           this->receive(reinterpret_cast<const Frame*>(data), size, false);
-      }, true)),
+      }, true, config)),
       internal_engine(std::make_unique<InternalEngine>(interface, [this](const void* data, size_t size) {
           this->receive(reinterpret_cast<const Frame*>(data), size, true);
-      }, true)) { // Member initializer list ends here
-    // Inicializa uma semente aleatória.
-    srand(getpid()); // Inicializa a semente com o PID do processo atual.
-    // Generate a random MAC address
-    for (auto& byte : mac_address) {
-        byte = static_cast<uint8_t>(rand() % 256);
-    }
-}
+      }, true, internal_config)) {} // Member initializer list ends here
 
 // Destruidor da classe NIC
 template <typename Engine>
 NIC<Engine>::~NIC() = default;  // O std::unique_ptr cuida da destruição da Engine
 
 // Configura o endereço MAC da interface
-template <typename Engine>
-void NIC<Engine>::set_address(const Mac_Address& addr) {
+void NIC_Base::set_address(const Mac_Address& addr) {
     mac_address = addr;
 }
 
 // Retorna o endereço MAC atual da interface
-template <typename Engine>
-const Mac_Address& NIC<Engine>::get_address() const {
+const Mac_Address& NIC_Base::get_address() const {
     return mac_address;
 }
 
 // Aloca um buffer para armazenar um frame Ethernet
-template <typename Engine>
-typename NIC<Engine>::Buffer* NIC<Engine>::alloc() {
-    Buffer* buffer = new Buffer();  // Cria um novo buffer para o frame Ethernet
+NIC_Base::Buffer* NIC_Base::alloc() {
+    // Retira um bloco do pool (esgotado: o evento é contado pelo pool)
+    void* block = buffer_pool.acquire();
+    if (block == nullptr) return nullptr;
+    Buffer* buffer = new (block) Buffer();  // Constrói o buffer no bloco (cabeçalho Ethernet padrão)
+    buffer->owner = this;
     buffer->size = sizeof(Ethernet::Frame); // Define o tamanho do buffer para 1500 bytes.
     return buffer;  // Retorna o ponteiro para o buffer alocado
 }
@@ -62,17 +103,18 @@ int NIC<Engine>::send(Buffer* buf, bool internal) {
     Ethernet::Frame* frame = &buf->frame;
 
     // Verifica se o tamanho do buffer não excede 1500 bytes (tamanho máximo permitido para Ethernet)
-    if (buf->size > 1500) return -1;
+    if (buf->size > sizeof(Ethernet::Frame)) { free(buf); return -1; }
 
     int result;
 
     // Verifica se o endereço de origem e destino são iguais
     if (internal) {
         // Se o endereço de origem e destino forem iguais, envia pelo internal_engine
-        result = internal_engine->send(frame, sizeof(*frame)); 
+        // apenas os buf->size bytes usados do frame (cabeçalhos + dados)
+        result = internal_engine->send(frame, buf->size);
     } else {
         // Se o endereço de origem e destino forem diferentes, envia pelo engine normal
-        result = engine->send(frame, sizeof(*frame));
+        result = engine->send(frame, buf->size);
     }
 
     free(buf);  // Libera o buffer após o envio
@@ -81,44 +123,100 @@ int NIC<Engine>::send(Buffer* buf, bool internal) {
 }
 
 
-// Método chamado pelo Engine quando um frame é recebido
+// Abre um lote de envio: frames externos ficam enfileirados na Engine
 template <typename Engine>
-void NIC<Engine>::receive(const Frame* frame, size_t size, bool is_internal) {
+void NIC<Engine>::begin_batch() {
+    engine->begin_batch();
+}
+
+// Fecha um lote de envio, enviando os frames enfileirados ao fechar o último
+template <typename Engine>
+int NIC<Engine>::end_batch() {
+    return engine->end_batch();
+}
+
+// Envia imediatamente os frames enfileirados
+template <typename Engine>
+int NIC<Engine>::flush() {
+    return engine->flush();
+}
 
-    // Aloca dinamicamente um buffer com o frame recebido
-    Buffer* buffer = new Buffer(*frame, size);
+// Método chamado pelo Engine quando um frame é recebido
+void NIC_Base::receive(const Frame* frame, size_t size, bool is_internal) {
+
+    // Retira um buffer do pool e copia apenas os bytes recebidos
+    // (o frame pode apontar direto para o anel da Engine e ser menor que um Frame completo).
+    // Sem buffers livres o frame é descartado (o pool conta o evento).
+    void* block = buffer_pool.acquire();
+    if (block == nullptr) return;
+    Buffer* buffer = new (block) Buffer();
+    buffer->owner = this;
+    buffer->size = (size > sizeof(Frame)) ? sizeof(Frame) : size;
+    std::memcpy(&buffer->frame, frame, buffer->size);
 
     // Pega protocolo correspondente ao frame recebido
     Ethernet::Protocol_Number protocol = ntohs(frame->type);
 
+    // Mantém uma referência durante a notificação: o observador que guardar a
+    // mensagem cria a sua; sem nenhuma, o buffer volta ao pool ao final.
+    MessageRef reference(buffer);
+
     // Notifica o observador do protocolo correspondente, passando o ponteiro do buffer
     observed.notify(protocol, buffer, is_internal);
 }
 
 // Retorna as estatísticas atuais da interface
-template <typename Engine>
-const typename NIC<Engine>::Statistics& NIC<Engine>::get_statistics() const {
+const NIC_Base::Statistics& NIC_Base::get_statistics() const {
     return stats;
 }
 
+// Retorna os contadores do pool de buffers
+BufferPool::Statistics NIC_Base::get_buffer_statistics() const {
+    return buffer_pool.statistics();
+}
+
 // Libera o buffer
+void NIC_Base::free(Buffer* buf) {
+    // Buffers do pool voltam para ele; os demais foram criados com new
+    if (buffer_pool.contains(buf)) {
+        buffer_pool.release(buf);
+    } else {
+        delete buf;
+    }
+}
+
+// Retorna o filtro padrão da Engine (protocolo e broadcast), que pode ser estendido
 template <typename Engine>
-void NIC<Engine>::free(Buffer* buf) {
-    delete buf;  // Libera a memória alocada para o buffer
+SocketFilter NIC<Engine>::default_filter() const {
+    return engine->default_filter();
 }
 
-// Adiciona um observador
+// Substitui o filtro de frames da Engine
+template <typename Engine>
+bool NIC<Engine>::set_filter(const SocketFilter& filter) {
+    return engine->set_filter(filter);
+}
+
+// Retorna os contadores da InternalEngine (comunicação interna)
 template <typename Engine>
-void NIC<Engine>::attach(Conditional_Data_Observer* obs) {
+InternalEngine::Statistics NIC<Engine>::get_internal_statistics() const {
+    return internal_engine->statistics();
+}
+
+// Adiciona um observador
+void NIC_Base::attach(Conditional_Data_Observer* obs) {
     observed.attach(obs);
 }
 
 // Remove um observador
-template <typename Engine>
-void NIC<Engine>::detach(Conditional_Data_Observer* obs) {
+void NIC_Base::detach(Conditional_Data_Observer* obs) {
     observed.detach(obs);
 }
 
 // Instancia o template para os tipos necessários (se você precisar de uma versão específica)
 template class NIC<Engine>;  // Aqui você precisa especificar qual engine usar
+template class NIC<XdpEngine>;
+template class NIC<IoUringEngine>;
+template class NIC<SimEngine>;
+template class NIC<ShmEngine>;
 
@@ -4,67 +4,266 @@
 
 
 #include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
 
 
-Concurrent_Observer::Concurrent_Observer() {
+Concurrent_Observer::Concurrent_Observer() : Concurrent_Observer(Config()) {}
+
+Concurrent_Observer::Concurrent_Observer(const Config& config) : _config(config) {
+    if (_config.capacity == 0) {
+        _config.capacity = 1;
+    }
+    stats.capacity = _config.capacity;
     sem_init(&semaphore, 0, 0);  // Inicializa o semáforo com 0
 }
 
+Concurrent_Observer::~Concurrent_Observer() {
+    sem_destroy(&semaphore);
+}
+
 bool Concurrent_Observer::hasMessage() {
     std::lock_guard<std::mutex> lock(mutex); // Protege o acesso à fila de mensagens
-    return !_message_buffer.empty();  // Verifica se a fila de mensagens não está vazia
+    return count > 0;  // Verifica se a fila de mensagens não está vazia
+}
+
+size_t Concurrent_Observer::KeyHash::operator()(const Key& key) const {
+    uint64_t hash = static_cast<uint64_t>(key.component_id) * 0x9E3779B97F4A7C15ULL ^ key.type;
+    for (uint8_t byte : key.vehicle_id) {
+        hash = (hash ^ byte) * 0x100000001B3ULL;
+    }
+    return static_cast<size_t>(hash);
 }
 
-void Concurrent_Observer::update(Message message) {
-    mutex.lock();
-    _message_buffer.push(message); // Adiciona mensagem na fila
-    mutex.unlock();
+Concurrent_Observer::Key Concurrent_Observer::key_of(const MessageRef& message) {
+    Ethernet::Address source = message.getSrcAddress();
+    return Key{source.vehicle_id, source.component_id, message.getType()};
+}
+
+bool Concurrent_Observer::conflates(const MessageRef& message) const {
+    if (!_config.conflate) {
+        return false;
+    }
+    if (_config.conflate_types.empty()) {
+        return true;
+    }
+    Ethernet::Type type = message.getType();
+    return std::find(_config.conflate_types.begin(), _config.conflate_types.end(), type) != _config.conflate_types.end();
+}
+
+// Esquece a chave da mensagem de sequência 'sequence', que saiu da fila.
+void Concurrent_Observer::forget(uint64_t sequence) {
+    if (pending.empty() || !conflates(slot(sequence))) {
+        return;
+    }
+    auto it = pending.find(key_of(slot(sequence)));
+    if (it != pending.end() && it->second == sequence) {
+        pending.erase(it);
+    }
+}
+
+void Concurrent_Observer::update(const MessageRef& message) {
+    // Com o pool da NIC baixo, a fila guarda uma cópia e o buffer volta para os envios.
+    MessageRef held = message.hold();
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // Conflação: substitui a mensagem pendente de mesma chave, sem ocupar outra posição.
+    bool conflated = !closed && conflates(message);
+    if (conflated) {
+        auto it = pending.find(key_of(message));
+        if (it != pending.end()) {
+            slot(it->second) = held;
+            stats.messages_conflated++;
+            stats.messages_queued++;
+            return;
+        }
+    }
+
+    if (count == _config.capacity && !closed) {
+        switch (_config.overflow) {
+            case Overflow::DROP_NEWEST:
+                stats.messages_dropped++;
+                return;
+            case Overflow::DROP_OLDEST:
+                // Substitui a mais antiga: a ocupação (e o semáforo) não muda
+                forget(first);
+                slot(first) = held;
+                if (conflated) {
+                    pending[key_of(message)] = first + count;
+                }
+                first++;
+                stats.messages_overwritten++;
+                stats.messages_queued++;
+                return;
+            case Overflow::BLOCK:
+                // O consumidor não pode esperar por espaço na própria fila
+                if (pthread_equal(pthread_self(), communicator_address.component_id)) {
+                    stats.messages_dropped++;
+                    return;
+                }
+                stats.producer_waits++;
+                producers_waiting++;
+                space.wait(lock, [&]() { return count < _config.capacity || closed; });
+                producers_waiting--;
+                // Outra mensagem de mesma chave pode ter entrado durante a espera
+                if (conflated && !closed && pending.count(key_of(message))) {
+                    slot(pending[key_of(message)]) = held;
+                    stats.messages_conflated++;
+                    stats.messages_queued++;
+                    return;
+                }
+                break;
+        }
+    }
+    if (closed) {
+        stats.messages_dropped++;
+        return;
+    }
+    if (count == _message_buffer.size()) {
+        grow();
+    }
+    slot(first + count) = held; // Adiciona mensagem na fila
+    if (conflated) {
+        pending[key_of(message)] = first + count;
+    }
+    count++;
+    stats.messages_queued++;
+    stats.high_water = std::max(stats.high_water, count);
+    lock.unlock();
 
     // Notifica que novos dados estão disponíveis
     sem_post(&semaphore);
 }
 
-Message Concurrent_Observer::updated() {
+MessageRef Concurrent_Observer::updated() {
     // Espera até que alguma mensagem esteja disponível
-    sem_wait(&semaphore);
+    while (sem_wait(&semaphore) != 0 && errno == EINTR) {}
+    return pop();
+}
+
+// Decrementa o semáforo, esperando no máximo até 'deadline'; retorna false se o prazo venceu.
+bool Concurrent_Observer::wait_until(std::chrono::steady_clock::time_point deadline) {
+    // steady_clock usa CLOCK_MONOTONIC: o prazo não é afetado por ajustes do relógio do sistema
+    auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    struct timespec abstime;
+    abstime.tv_sec = since_epoch > 0 ? since_epoch / 1000000000 : 0;
+    abstime.tv_nsec = since_epoch > 0 ? since_epoch % 1000000000 : 0;
+    while (sem_clockwait(&semaphore, CLOCK_MONOTONIC, &abstime) != 0) {
+        if (errno != EINTR) {
+            return false;  // ETIMEDOUT
+        }
+    }
+    return true;
+}
+
+bool Concurrent_Observer::updated_until(MessageRef* message, std::chrono::steady_clock::time_point deadline) {
+    if (!wait_until(deadline)) {
+        return false;
+    }
+    *message = pop();
+    return true;
+}
 
-    mutex.lock();
-    Message message = _message_buffer.front(); // Obtém o primeiro elemento da fila
-    _message_buffer.pop();  // Remove o elemento da fila
-    mutex.unlock();
+size_t Concurrent_Observer::updated_many(MessageRef* messages, size_t max, std::chrono::steady_clock::time_point deadline) {
+    if (max == 0 || !wait_until(deadline)) {
+        return 0;
+    }
+    // Reserva as demais mensagens já sinalizadas sem dormir (sem_trywait não faz syscall)
+    size_t taken = 1;
+    while (taken < max && sem_trywait(&semaphore) == 0) {
+        taken++;
+    }
 
+    std::unique_lock<std::mutex> lock(mutex);
+    for (size_t i = 0; i < taken; i++) {
+        forget(first);
+        messages[i] = std::move(slot(first));
+        first++;
+    }
+    count -= taken;
+    bool wake = producers_waiting > 0;
+    lock.unlock();
+
+    if (wake) {
+        space.notify_all();
+    }
+    return taken;
+}
+
+// Retira a mensagem mais antiga (o semáforo já foi decrementado).
+MessageRef Concurrent_Observer::pop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    forget(first);
+    MessageRef message = std::move(slot(first)); // Obtém o primeiro elemento da fila
+    first++;  // Remove o elemento da fila
+    count--;
+    bool wake = producers_waiting > 0;
+    lock.unlock();
+
+    if (wake) {
+        space.notify_one();
+    }
     return message; // Retorna a mensagem
 }
 
+void Concurrent_Observer::grow() {
+    // Dobra a fila (até a capacidade); cada mensagem vai para a posição da sua sequência no novo tamanho
+    size_t size = std::min(_config.capacity, std::max<size_t>(16, 2 * _message_buffer.size()));
+    std::vector<MessageRef> buffer(size);
+    for (uint64_t sequence = first; sequence < first + count; sequence++) {
+        buffer[sequence % size] = std::move(slot(sequence));
+    }
+    _message_buffer.swap(buffer);
+}
+
+void Concurrent_Observer::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    space.notify_all();
+}
+
+Concurrent_Observer::Statistics Concurrent_Observer::statistics() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
 void Concurrent_Observed::attach(Concurrent_Observer* observer) {
-    mutex.lock();
-    observers.emplace_back(observer);
-    mutex.unlock();
+    // Publica uma cópia do índice com o novo observador (o primeiro de cada componente é mantido)
+    Ethernet::Thread_ID component_id = observer->communicator_address.component_id;
+    observers.update([&](Index& index) {
+        index.emplace(component_id, observer);
+    });
 }
 
 void Concurrent_Observed::detach(Concurrent_Observer* observer) {
-    mutex.lock();
-    observers.remove(observer);  // Remove o observador da lista
-    mutex.unlock();
+    // Publica uma cópia do índice sem o observador (retorna após os notify que usavam o índice antigo)
+    Ethernet::Thread_ID component_id = observer->communicator_address.component_id;
+    observers.update([&](Index& index) {
+        auto it = index.find(component_id);
+        if (it != index.end() && it->second == observer) {
+            index.erase(it);
+        }
+    });
 }
 
-void Concurrent_Observed::notify(Message message) {
+void Concurrent_Observed::notify(const MessageRef& message) {
     // Extrai endereco de origem da mensagem.
     Ethernet::Address src_address = message.getSrcAddress();
     // Extrai endereco de destino da mensagem.
     Ethernet::Address dst_address = message.getDstAddress();
-    mutex.lock();
     // Utilizado quando: Endereco de destino foi preenchido. ((thread_id) != (pthread_t)0)
     if (!pthread_equal(dst_address.component_id, (pthread_t)0)) {
-        for (Concurrent_Observer* obs : observers) {
-            // Notifica o observador do componente de id especifico.
-            if (obs->communicator_address.component_id == dst_address.component_id) {
-                obs->update(message);
-                break;
-            }
+        auto index = observers.read();
+        // Notifica o observador do componente de id especifico.
+        Ethernet::Thread_ID component_id = dst_address.component_id;
+        auto it = index->find(component_id);
+        if (it != index->end()) {
+            it->second->update(message);
         }
     }
-    mutex.unlock();
 }
 
 Conditional_Data_Observer::Conditional_Data_Observer(Protocol* protocol, Protocol_Number protocol_number)
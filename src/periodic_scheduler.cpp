@@ -0,0 +1,157 @@
+#include "../include/periodic_scheduler.hpp"
+
+#include <algorithm>
+
+// Constructor; the pool is started with the first task
+PeriodicScheduler::PeriodicScheduler(unsigned int threads)
+    : thread_count(std::max(1u, threads)) {}
+
+// Destructor: stops the pool and drops the remaining tasks
+PeriodicScheduler::~PeriodicScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// Method to schedule a task
+PeriodicScheduler::Handle PeriodicScheduler::add(std::chrono::microseconds period, Task task) {
+    auto entry = std::make_shared<Entry>();
+    entry->period = std::max<Clock::duration>(period, std::chrono::microseconds(1));
+    entry->task = std::move(task);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entry->handle = next_handle++;
+    entries.emplace(entry->handle, entry);
+
+    Clock::time_point release = Clock::now() + entry->period;
+    releases.push(Release{release, release + entry->period, entry});
+
+    if (threads.empty()) {
+        for (unsigned int i = 0; i < thread_count; ++i) {
+            threads.emplace_back(&PeriodicScheduler::run, this);
+        }
+    } else if (releases.top().entry == entry) {
+        // The pool sleeps until a later release
+        wake.notify_all();
+    }
+    return entry->handle;
+}
+
+// Method to cancel a task
+bool PeriodicScheduler::remove(Handle handle, Statistics* final_stats) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = entries.find(handle);
+    if (it == entries.end()) {
+        return false;
+    }
+    std::shared_ptr<Entry> entry = std::move(it->second);
+    entries.erase(it);
+
+    // Its pending release is skipped when it reaches the top of the heap
+    entry->active = false;
+    if (entry->running != std::this_thread::get_id()) {
+        finished.wait(lock, [&]() { return entry->running == std::thread::id(); });
+    }
+    if (final_stats != nullptr) {
+        *final_stats = snapshot(*entry);
+    }
+    return true;
+}
+
+// Method run by each pool thread
+void PeriodicScheduler::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (releases.empty()) {
+            wake.wait(lock);
+            continue;
+        }
+        if (!releases.top().entry->active) {
+            releases.pop();
+            continue;
+        }
+        if (releases.top().time > Clock::now()) {
+            // Copied: add() may reallocate the heap while this thread waits
+            Clock::time_point release_time = releases.top().time;
+            wake.wait_until(lock, release_time);
+            continue;
+        }
+
+        // Earliest release first; among equal releases, earliest deadline first
+        Release release = releases.top();
+        releases.pop();
+        Entry& entry = *release.entry;
+        entry.running = std::this_thread::get_id();
+
+        // Let another pool thread take the next due task while this one runs
+        if (!releases.empty() && releases.top().time <= release.time) {
+            wake.notify_one();
+        }
+
+        lock.unlock();
+        Clock::time_point started = Clock::now();
+        entry.task();
+        lock.lock();
+
+        entry.running = std::thread::id();
+        Clock::duration jitter = started - release.time;
+        entry.releases++;
+        entry.total_jitter += jitter;
+        entry.max_jitter = std::max(entry.max_jitter, jitter);
+        if (started > release.deadline) {
+            entry.deadline_misses++;
+        }
+
+        if (!entry.active) {
+            finished.notify_all();
+            continue;
+        }
+
+        // Next release one period after this one, skipping those already past
+        Clock::time_point next = release.time + entry.period;
+        Clock::time_point now = Clock::now();
+        while (next + entry.period <= now) {
+            next += entry.period;
+            entry.deadline_misses++;
+        }
+        releases.push(Release{next, next + entry.period, release.entry});
+    }
+}
+
+// Method returning the counters of every scheduled task
+std::vector<PeriodicScheduler::Statistics> PeriodicScheduler::statistics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Statistics> result;
+    result.reserve(entries.size());
+    for (const auto& item : entries) {
+        result.push_back(snapshot(*item.second));
+    }
+    std::sort(result.begin(), result.end(),
+              [](const Statistics& a, const Statistics& b) { return a.handle < b.handle; });
+    return result;
+}
+
+// Method returning the counters of one task (called with the mutex held)
+PeriodicScheduler::Statistics PeriodicScheduler::snapshot(const Entry& entry) {
+    Statistics stats;
+    stats.handle = entry.handle;
+    stats.period = std::chrono::duration_cast<std::chrono::microseconds>(entry.period);
+    stats.releases = entry.releases;
+    stats.deadline_misses = entry.deadline_misses;
+    stats.max_jitter = std::chrono::duration_cast<std::chrono::microseconds>(entry.max_jitter);
+    if (entry.releases > 0) {
+        stats.mean_jitter = std::chrono::duration_cast<std::chrono::microseconds>(entry.total_jitter / entry.releases);
+    }
+    return stats;
+}
+
+// Method returning the number of scheduled tasks
+size_t PeriodicScheduler::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
@@ -3,39 +3,53 @@
 
 #include <iostream>
 
-Protocol::Protocol(NIC<Engine>* nic, DataPublisher* data_publisher, Protocol_Number protocol_number,
+Protocol::Protocol(NIC_Base* nic, DataPublisher* data_publisher, Protocol_Number protocol_number,
                                                     RSUHandler* rsu_handler, TimeSyncManager* tsm) 
     : _nic(nic), _data_publisher(data_publisher), _time_sync_manager(tsm), protocol_number(protocol_number),
       _data_observer(this, protocol_number), _rsu_handler(rsu_handler)
 {   
     _nic->attach(&_data_observer);
+
+    // Filtra no kernel os frames externos que seriam descartados em processExternalReceive:
+    // apenas mensagens para este veiculo ou sem destino (broadcast) sao aceitas.
+    Ethernet::Mac_Address mac_nulo = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    SocketFilter filter = _nic->default_filter();
+    filter.require(Ethernet::DST_VEHICLE_OFFSET, {SocketFilter::bytes(mac_nulo), SocketFilter::bytes(_nic->get_address())});
+    // Se for RSU: aceita apenas JOIN REQ e DELAY REQ.
+    if (_rsu_handler == nullptr) {
+        filter.require(Ethernet::TYPE_OFFSET, {SocketFilter::bytes(Ethernet::TYPE_PTP_DELAY_REQ),
+                                               SocketFilter::bytes(Ethernet::TYPE_RSU_JOIN_REQ)});
+    }
+    _nic->set_filter(filter);
 }
 
 Protocol::~Protocol() {
     _nic->detach(&_data_observer);
 }
 
-// Método de preenchimento das mensagens de envio interno.
-void Protocol::processInternalSend(Ethernet::InternalPayload* payload,
-    Ethernet::Thread_ID src_component, Ethernet::Thread_ID dst_component, Type type, Period period) {
+// Método de preenchimento do cabeçalho das mensagens de envio interno.
+void Protocol::processInternalSend(Ethernet::InternalHeader* header,
+    Ethernet::Thread_ID src_component, Ethernet::Thread_ID dst_component, Type type, Period period, unsigned int size) {
     
-    // Preenche Payload com o cabeçalho e a mensagem
-    payload->header.src_component_id = src_component;
-    payload->header.dst_component_id = dst_component;
-    payload->header.type = type;
-    payload->header.period = period;
+    // Preenche o cabeçalho
+    header->src_component_id = src_component;
+    header->dst_component_id = dst_component;
+    header->type = type;
+    header->period = period;
+    header->length = static_cast<Ethernet::Length>(size);
 }
 
-// Método de preenchimento das mensagens de envio externo.
-void Protocol::processExternalSend(Ethernet::ExternalPayload* payload,
-    Address from, Address to, Type type, Period period, Quadrant_ID group_id, MAC_key mac) {
-    // Preenche Payload com o cabeçalho e a mensagem
-    payload->header.src_address = from;      // Endereço de origem
-    payload->header.dst_address = to;        // Endereço de destino
-    payload->header.type = type;             // Tipo da mensagem
-    payload->header.period = period;         // Período de transmissão
-    payload->header.quadrant_id = group_id;     // Identificador do grupo
-    payload->header.mac = mac;               // MAC da mensagem
+// Método de preenchimento do cabeçalho das mensagens de envio externo.
+void Protocol::processExternalSend(Ethernet::ExternalHeader* header,
+    Address from, Address to, Type type, Period period, Quadrant_ID group_id, MAC_key mac, unsigned int size) {
+    // Preenche o cabeçalho (o tamanho entra no calculo do MAC, feito abaixo)
+    header->src_address = from;      // Endereço de origem
+    header->dst_address = to;        // Endereço de destino
+    header->type = type;             // Tipo da mensagem
+    header->period = period;         // Período de transmissão
+    header->length = static_cast<Ethernet::Length>(size); // Tamanho dos dados
+    header->quadrant_id = group_id;     // Identificador do grupo
+    header->mac = mac;               // MAC da mensagem
 
     std::chrono::system_clock::time_point now;
 
@@ -49,16 +63,16 @@ void Protocol::processExternalSend(Ethernet::ExternalPayload* payload,
     }
 
     // Preenche o timestamp.
-    payload->header.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();   // Horario de envio
+    header->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();   // Horario de envio
 
     // Preenche grupo e mac da mensagem (apenas veiculos).
     if (_rsu_handler != nullptr &&
-        payload->header.type != Ethernet::TYPE_PTP_DELAY_REQ &&
-        payload->header.type != Ethernet::TYPE_RSU_JOIN_REQ) {
+        header->type != Ethernet::TYPE_PTP_DELAY_REQ &&
+        header->type != Ethernet::TYPE_RSU_JOIN_REQ) {
         // Preenche id do grupo.
-        payload->header.quadrant_id = _rsu_handler->getCurrentGroupID();
+        header->quadrant_id = _rsu_handler->getCurrentGroupID();
         // Preenche MAC da mensagem.
-        payload->header.mac = _rsu_handler->generate_mac(payload->header, _rsu_handler->getGroupMAC(payload->header.quadrant_id));
+        header->mac = _rsu_handler->generate_mac(*header, _rsu_handler->getGroupMAC(header->quadrant_id));
         //std::cout << "ENVIANDO MSG COM ID DO GRUPO: " << (int)payload.header.group_id << std::endl;
     }
 }
@@ -83,26 +97,38 @@ int Protocol::send(Address from, Address to, Type type, Period period, Quadrant_
     //   se o Veiculo ainda nao faz parte de nenhum grupo.
     if (_rsu_handler != nullptr && !is_internal &&
         !_rsu_handler->hasGroup() && type != Ethernet::TYPE_RSU_JOIN_REQ) {
+        _nic->free(buf);
         return -1;
     }
 
-    // Preenche estrutura payload de acordo com tipo de comunicação.
+    // Preenche o cabeçalho de acordo com tipo de comunicação e copia para o frame
+    // apenas o cabeçalho e os 'size' bytes de dados (o frame enviado tem só esse tamanho).
     if (is_internal) {
-        Ethernet::InternalPayload payload;
-        // Preenche payload interno.
-        processInternalSend(&payload, from.component_id, to.component_id, type, period);
-        // Copia os dados da mensagem para a estrutura payload.
-        std::memcpy(payload.data, data, size);
+        Ethernet::InternalHeader header;
+        // Preenche cabeçalho interno.
+        processInternalSend(&header, from.component_id, to.component_id, type, period, size);
+        // Entrega direta: sem montar o frame nem passar pela InternalEngine, a mensagem
+        // é entregue na thread do remetente como se tivesse sido recebida.
+        if (_internal_fast_path) {
+            if (size > sizeof(Ethernet::InternalPayload::data)) {
+                std::cerr << "Payload size exceeds maximum allowed size: " << size << " > " << sizeof(Ethernet::InternalPayload::data) << std::endl;
+                _nic->free(buf);
+                return -1;
+            }
+            std::memcpy(buf->frame.payload, data, size);
+            processInternalReceive(buf, header, buf->frame.payload);
+            return static_cast<int>(Ethernet::internalFrameSize(size));
+        }
         // Preenche o payload do frame com os dados de comunicação interna.
-        if (!_nic->fillInternalPayload(&buf->frame, &payload)) { return -1; }
+        if (!_nic->fillInternalPayload(&buf->frame, &header, data, size)) { _nic->free(buf); return -1; }
+        buf->size = Ethernet::internalFrameSize(size);
     } else {
-        Ethernet::ExternalPayload payload;
-        // Preenche payload externo.
-        processExternalSend(&payload, from, to, type, period, group_id, mac);
-        // Copia os dados da mensagem para a estrutura payload.
-        std::memcpy(payload.data, data, size);
+        Ethernet::ExternalHeader header;
+        // Preenche cabeçalho externo.
+        processExternalSend(&header, from, to, type, period, group_id, mac, size);
         // Preenche o payload do frame com os dados de comunicação externa.
-        if (!_nic->fillExternalPayload(&buf->frame, &payload)) { return -1; }
+        if (!_nic->fillExternalPayload(&buf->frame, &header, data, size)) { _nic->free(buf); return -1; }
+        buf->size = Ethernet::externalFrameSize(size);
     }
     
     // Envia o frame Ethernet para a NIC
@@ -110,39 +136,45 @@ int Protocol::send(Address from, Address to, Type type, Period period, Quadrant_
 }
 
 // Método de processamento para as mensagens recebidas internamente.
-void Protocol::processInternalReceive(Ethernet::InternalPayload payload) {
-    // Preenche mensagem com o cabeçalho e os dados recebidos.
-    Message message;
-    message.setSrcAddress({_nic->get_address(), payload.header.src_component_id});       // Endereço de origem
-    message.setDstAddress({_nic->get_address(), payload.header.dst_component_id});       // Endereço de destino
-    message.setType(payload.header.type);                                               // Tipo da mensagem
-    message.setPeriod(payload.header.period);                                           // Período de transmissão
-    message.setTimestamp(_time_sync_manager->now());                                    // Horario de envio (mesmo do recebimento)
-    message.setGroupKey(_rsu_handler->getGroupMAC(_rsu_handler->getCurrentGroupID()));  // Chave MAC do grupo atual (usada para gerar MAC)
-    message.setData(payload.data, sizeof(payload.data));                                // Copia os dados para a mensagem
+void Protocol::processInternalReceive(Buffer* buffer, const Ethernet::InternalHeader& header, const uint8_t* data) {
+    // Preenche a mensagem guardada no próprio buffer recebido (os dados continuam no frame).
+    Ethernet::ExternalHeader& message = buffer->header;
+    message.src_address = {_nic->get_address(), header.src_component_id};                // Endereço de origem
+    message.dst_address = {_nic->get_address(), header.dst_component_id};                // Endereço de destino
+    message.type = header.type;                                                          // Tipo da mensagem
+    message.period = header.period;                                                      // Período de transmissão
+    message.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+        _time_sync_manager->now().time_since_epoch()).count();                           // Horario de envio (mesmo do recebimento)
+    message.length = header.length;                                                      // Tamanho dos dados
+    message.mac = {0};                                                                   // Gerado na leitura com a chave do grupo
+    message.quadrant_id = 0;                                                             // Identificador do grupo (não usado)
+    buffer->group_key = _rsu_handler->getGroupMAC(_rsu_handler->getCurrentGroupID());    // Chave MAC do grupo atual (usada para gerar MAC)
+    buffer->data = data;                                                                 // Dados dentro do frame
+    buffer->data_size = header.length;
+    MessageRef reference(buffer);
 
     // Encaminha mensagens de interesse direto para o DataPublisher.
-    if (pthread_equal(payload.header.dst_component_id, (pthread_t)0)) {
-        _data_publisher->notify(message);
+    if (pthread_equal(header.dst_component_id, (pthread_t)0)) {
+        _data_publisher->notify(reference);
     } else {
         // Notifica os observadores com o endereço de destino e a mensagem
-        _observed.notify(message);
+        _observed.notify(reference);
     }
 }
 
 // Método de processamento para as mensagens recebidas externamente.
-void Protocol::processExternalReceive(Ethernet::ExternalPayload payload) {
+void Protocol::processExternalReceive(Buffer* buffer, const Ethernet::ExternalHeader& header, const uint8_t* data) {
     // Se for RSU: descarta mensagens que nao sao JOIN REQ ou DELAY REQ.
     if (_rsu_handler == nullptr && 
-        payload.header.type != Ethernet::TYPE_PTP_DELAY_REQ &&
-        payload.header.type != Ethernet::TYPE_RSU_JOIN_REQ) {
+        header.type != Ethernet::TYPE_PTP_DELAY_REQ &&
+        header.type != Ethernet::TYPE_RSU_JOIN_REQ) {
         return;
     }
 
     // Descarta mensagens que não foram encaminhadas para esse veiculo.
     std::array<uint8_t, 6> mac_nulo = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-    if (payload.header.dst_address.vehicle_id != mac_nulo &&
-        _nic->get_address() != payload.header.dst_address.vehicle_id) {
+    if (header.dst_address.vehicle_id != mac_nulo &&
+        _nic->get_address() != header.dst_address.vehicle_id) {
         return;
     }
 
@@ -150,19 +182,19 @@ void Protocol::processExternalReceive(Ethernet::ExternalPayload payload) {
     // ao grupo do veiculo, ou a nenhum grupo vizinho, ou que foram adulteradas.
     if (_rsu_handler != nullptr) {
         // Verifica se mensagem eh externa.
-        if (payload.header.src_address.vehicle_id != _nic->get_address()) {
+        if (header.src_address.vehicle_id != _nic->get_address()) {
             // Desconsidera mensagens enviadas pela RSU.
-            if (payload.header.type != Ethernet::TYPE_PTP_SYNC &&
-                payload.header.type != Ethernet::TYPE_PTP_DELAY_RESP &&
-                payload.header.type != Ethernet::TYPE_RSU_JOIN_RESP) {
+            if (header.type != Ethernet::TYPE_PTP_SYNC &&
+                header.type != Ethernet::TYPE_PTP_DELAY_RESP &&
+                header.type != Ethernet::TYPE_RSU_JOIN_RESP) {
                 // Descarta mensagens de grupos que o veiculo nao pertence e nao eh vizinho.
-                if (payload.header.quadrant_id != _rsu_handler->getCurrentGroupID() &&
-                    !_rsu_handler->isNeighborGroup(payload.header.quadrant_id)) {
+                if (header.quadrant_id != _rsu_handler->getCurrentGroupID() &&
+                    !_rsu_handler->isNeighborGroup(header.quadrant_id)) {
                     return;
                 } else {
-                    //std::cout << (int)_rsu_handler->getCurrentGroupID() << " RECEBEU INTERESSE EM POSICAO DO GRUPO: " << (int)payload.header.group_id << std::endl;
+                    //std::cout << (int)_rsu_handler->getCurrentGroupID() << " RECEBEU INTERESSE EM POSICAO DO GRUPO: " << (int)header.group_id << std::endl;
                     // Verifica MAC da mensagem.
-                    if (!_rsu_handler->verify_mac(payload.header)) {
+                    if (!_rsu_handler->verify_mac(header)) {
                         return; // Descarta mensagem se MAC invalido.
                     }
                     //std::cout << "MAC VALIDADO: PROCESSANDO MENSAGEM." << std::endl;
@@ -171,53 +203,57 @@ void Protocol::processExternalReceive(Ethernet::ExternalPayload payload) {
         }
     }
 
-    // Monta mensagem com o cabeçalho e os dados recebidos.
-    Message message;
-    message.setSrcAddress(payload.header.src_address);   // Endereço de origem
-    message.setDstAddress(payload.header.dst_address);   // Endereço de destino
-    message.setType(payload.header.type);                // Tipo da mensagem
-    message.setPeriod(payload.header.period);            // Período de transmissão
-    message.setTimestamp(std::chrono::time_point<std::chrono::system_clock>(std::chrono::nanoseconds(payload.header.timestamp))); // Horario de envio
-    message.setGroupID(payload.header.quadrant_id);         // Identificador do grupo
-    message.setMAC(payload.header.mac);                  // MAC da mensagem
-    message.setData(payload.data, sizeof(payload.data)); // Copia os dados para a mensagem
+    // Monta a mensagem no próprio buffer recebido, com o cabeçalho lido e os dados no frame.
+    buffer->header = header;
+    buffer->header.timestamp = header.timestamp / 1000;  // Horario de envio (nanossegundos no frame, microssegundos na mensagem)
+    buffer->data = data;
+    buffer->data_size = header.length;
+    MessageRef reference(buffer);
 
     // Encaminha mensagens de interesse direto para o DataPublisher.
-    if (pthread_equal(payload.header.dst_address.component_id, (pthread_t)0)) {
-        _data_publisher->notify(message);
+    if (pthread_equal(header.dst_address.component_id, (pthread_t)0)) {
+        _data_publisher->notify(reference);
     } else {
         // Notifica os observadores com o endereço de destino e a mensagem
-        _observed.notify(message);
+        _observed.notify(reference);
     }
 
 }
 
 void Protocol::receive(void* buf, bool is_internal) {
     // Conversão direta de void* para Buffer*
+    // (a NIC mantém o buffer enquanto houver MessageRef para a mensagem guardada nele).
     Buffer* buffer = static_cast<Buffer*>(buf);
 
     // Verifica se a mensagem é interna ou externa.
     if (is_internal) {
-        // Inicializa payload interno para extrair os dados.
-        Ethernet::InternalPayload payload;
-        // Extrai o payload do frame recebido.
-        _nic->extractInternalPayload(&buffer->frame, &payload);
-         // Libera o buffer após o uso
-        delete buffer;
-        // Processa recebimento interno.
-        processInternalReceive(payload);
+        Ethernet::InternalHeader header;
+        // Lê o cabeçalho do frame recebido; os dados não são copiados.
+        const uint8_t* data = _nic->readInternalPayload(&buffer->frame, buffer->size, &header);
+        // Processa recebimento interno (descarta frames truncados).
+        if (data != nullptr) processInternalReceive(buffer, header, data);
     } else {
-        // Inicializa payload externo para extrair os dados.
-        Ethernet::ExternalPayload payload;
-        // Extrai o payload do frame recebido.
-        _nic->extractExternalPayload(&buffer->frame, &payload);
-        // Libera o buffer após o uso
-        delete buffer;
-        // Processa recebimento externo.
-        processExternalReceive(payload);
+        Ethernet::ExternalHeader header;
+        // Lê o cabeçalho do frame recebido; os dados não são copiados.
+        const uint8_t* data = _nic->readExternalPayload(&buffer->frame, buffer->size, &header);
+        // Processa recebimento externo (descarta frames truncados).
+        if (data != nullptr) processExternalReceive(buffer, header, data);
     }
 }
 
+// Liga ou desliga a entrega direta das mensagens internas (desligada, elas passam pela InternalEngine).
+void Protocol::set_internal_fast_path(bool enabled) {
+    _internal_fast_path = enabled;
+}
+
+void Protocol::begin_batch() {
+    _nic->begin_batch();
+}
+
+int Protocol::end_batch() {
+    return _nic->end_batch();
+}
+
 void Protocol::attach(Concurrent_Observer* obs) {
     _observed.attach(obs);
 }
@@ -0,0 +1,172 @@
+#include "../include/reactor.hpp"
+#include <iostream>
+#include <thread>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+
+// Returns the reactor of the current process (never destroyed, see header)
+Reactor& Reactor::instance() {
+    static Reactor* reactor = new Reactor();
+    return *reactor;
+}
+
+// Constructor
+Reactor::Reactor() {
+    pthread_atfork(&Reactor::before_fork, &Reactor::after_fork_parent, &Reactor::after_fork_child);
+}
+
+// Method to set the number of receive threads
+void Reactor::set_thread_count(unsigned int count) {
+    Reactor& reactor = instance();
+    std::lock_guard<std::mutex> lock(reactor.mutex);
+    reactor.thread_count = (count == 0) ? 1 : count;
+    if (reactor._epoll_fd >= 0) {
+        reactor.start_locked();
+    }
+}
+
+// Method to raise the number of receive threads
+void Reactor::reserve_threads(unsigned int count) {
+    Reactor& reactor = instance();
+    std::lock_guard<std::mutex> lock(reactor.mutex);
+    if (count > reactor.thread_count) {
+        reactor.thread_count = count;
+        if (reactor._epoll_fd >= 0) {
+            reactor.start_locked();
+        }
+    }
+}
+
+// Method to create the epoll instance and the missing threads (mutex must be held)
+void Reactor::start_locked() {
+    if (_epoll_fd < 0) {
+        _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (_epoll_fd < 0) {
+            perror("Error creating epoll instance");
+            exit(EXIT_FAILURE);
+        }
+    }
+    while (running_threads < thread_count) {
+        std::thread(&Reactor::loop, this).detach();
+        running_threads++;
+    }
+}
+
+// Method to register a descriptor
+uint64_t Reactor::add(int fd, Handler handler) {
+    std::lock_guard<std::mutex> lock(mutex);
+    start_locked();
+
+    uint64_t id = next_id++;
+    auto registration = std::make_shared<Registration>();
+    registration->fd = fd;
+    registration->handler = std::move(handler);
+    registrations[id] = registration;
+
+    struct epoll_event event {};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.u64 = id;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        perror("Error adding descriptor to epoll");
+        registrations.erase(id);
+        return 0;
+    }
+    return id;
+}
+
+// Method to remove a descriptor
+void Reactor::remove(uint64_t id) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = registrations.find(id);
+    if (it == registrations.end()) {
+        return;
+    }
+    std::shared_ptr<Registration> registration = it->second;
+    registrations.erase(it);
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, registration->fd, nullptr);
+
+    // Wait for a handler currently running on a reactor thread
+    idle_cv.wait(lock, [&]() { return !registration->busy; });
+}
+
+// Method implementing the reactor thread loop
+void Reactor::loop() {
+    constexpr int MAX_EVENTS = 16;
+    struct epoll_event events[MAX_EVENTS];
+
+    int epoll_fd;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        epoll_fd = _epoll_fd;
+    }
+
+    while (true) {
+        int ready = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("Error waiting on epoll");
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            uint64_t id = events[i].data.u64;
+
+            // Mark the registration as busy so that remove() waits for the handler
+            std::shared_ptr<Registration> registration;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = registrations.find(id);
+                if (it == registrations.end()) {
+                    continue;
+                }
+                registration = it->second;
+                registration->busy = true;
+            }
+
+            registration->handler();
+
+            // Re-arm the descriptor unless it was removed meanwhile
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                registration->busy = false;
+                if (registrations.count(id) > 0) {
+                    struct epoll_event event {};
+                    event.events = EPOLLIN | EPOLLONESHOT;
+                    event.data.u64 = id;
+                    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, registration->fd, &event);
+                }
+            }
+            idle_cv.notify_all();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    running_threads--;
+}
+
+// Fork handler: keep the state consistent while the process is copied
+void Reactor::before_fork() {
+    instance().mutex.lock();
+}
+
+// Fork handler (parent): resume normally
+void Reactor::after_fork_parent() {
+    instance().mutex.unlock();
+}
+
+// Fork handler (child): drop the parent's threads, epoll instance and registrations
+void Reactor::after_fork_child() {
+    Reactor& reactor = instance();
+    if (reactor._epoll_fd >= 0) {
+        close(reactor._epoll_fd);
+        reactor._epoll_fd = -1;
+    }
+    reactor.registrations.clear();
+    reactor.running_threads = 0;
+    reactor.mutex.unlock();
+}
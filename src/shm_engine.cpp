@@ -0,0 +1,326 @@
+#include "../include/shm_engine.hpp"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// Identifies an initialised ring
+static constexpr uint32_t RING_MAGIC = 0x53484D52; // "SHMR"
+
+// Shared header at the start of the ring. 'reserve' is the next ticket handed
+// to a sender and 'futex' changes on every publish so that readers can sleep on it.
+struct ShmEngine::RingHeader {
+    uint32_t magic;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    uint32_t futex;
+    uint32_t waiters;
+    uint32_t reserved;
+    alignas(64) uint64_t reserve;
+};
+
+// Slot header, followed by slot_size bytes of frame data.
+// 'sequence' is 2 * ticket + 1 while the slot is written and 2 * ticket + 2 once published.
+struct ShmEngine::Slot {
+    uint64_t sequence;
+    uint64_t sender;
+    uint32_t size;
+    uint32_t reserved;
+};
+
+static int futex(uint32_t* address, int operation, uint32_t value, const struct timespec* timeout) {
+    return static_cast<int>(syscall(SYS_futex, address, operation, value, timeout, nullptr, 0));
+}
+
+// Constructor
+ShmEngine::ShmEngine(const std::string& interface, Callback callback, bool enable_receive)
+    : ShmEngine(interface, callback, enable_receive, Config()) {}
+
+// Constructor with explicit configuration
+ShmEngine::ShmEngine(const std::string& interface, Callback callback, bool enable_receive, const Config& config)
+    : _interface(interface), _callback(callback), _config(config) {
+    // Unique among every engine of every process on the host
+    static std::atomic<uint32_t> next_local_id{1};
+    _id = (static_cast<uint64_t>(getpid()) << 32) | next_local_id++;
+
+    filter = default_filter();
+    if (!map_ring(object_name(interface))) {
+        exit(EXIT_FAILURE);
+    }
+
+    // Readers only see frames sent after they joined
+    if (enable_receive) {
+        cursor = __atomic_load_n(&header->reserve, __ATOMIC_ACQUIRE);
+        running = true;
+        reader_thread = std::thread(&ShmEngine::receive_loop, this);
+    }
+}
+
+// Destructor
+ShmEngine::~ShmEngine() {
+    if (running) {
+        running = false;
+        futex(&header->futex, FUTEX_WAKE, INT_MAX, nullptr);
+        reader_thread.join();
+    }
+    if (header != nullptr) {
+        munmap(header, map_size);
+    }
+}
+
+// Method returning the shared memory object name of an interface
+std::string ShmEngine::object_name(const std::string& interface) {
+    return "/shm_engine_" + interface;
+}
+
+// Method to create (or open) the ring and map it into the process
+bool ShmEngine::map_ring(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+    bool creator = fd >= 0;
+    if (!creator && errno == EEXIST) {
+        fd = shm_open(name.c_str(), O_RDWR, 0);
+    }
+    if (fd < 0) {
+        perror("Error opening shared memory ring");
+        return false;
+    }
+
+    if (creator) {
+        unsigned int count = 1;
+        while (count < _config.slot_count) {
+            count <<= 1;
+        }
+        slot_stride = (sizeof(Slot) + _config.slot_size + 63) & ~static_cast<size_t>(63);
+        map_size = sizeof(RingHeader) + count * slot_stride;
+        if (ftruncate(fd, static_cast<off_t>(map_size)) < 0) {
+            perror("Error sizing shared memory ring");
+            close(fd);
+            shm_unlink(name.c_str());
+            return false;
+        }
+        void* map = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            perror("Error mapping shared memory ring");
+            return false;
+        }
+        header = static_cast<RingHeader*>(map);
+        header->slot_count = count;
+        header->slot_size = _config.slot_size;
+        __atomic_store_n(&header->magic, RING_MAGIC, __ATOMIC_RELEASE);
+    } else {
+        // Wait for the creator to size and initialise the ring
+        struct stat st {};
+        for (int attempt = 0; fstat(fd, &st) == 0 && st.st_size == 0 && attempt < 1000; ++attempt) {
+            usleep(1000);
+        }
+        if (st.st_size < static_cast<off_t>(sizeof(RingHeader))) {
+            std::cerr << "Error opening shared memory ring " << name << ": not initialised" << std::endl;
+            close(fd);
+            return false;
+        }
+        map_size = static_cast<size_t>(st.st_size);
+        void* map = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            perror("Error mapping shared memory ring");
+            return false;
+        }
+        header = static_cast<RingHeader*>(map);
+        for (int attempt = 0; __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != RING_MAGIC && attempt < 1000; ++attempt) {
+            usleep(1000);
+        }
+        if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != RING_MAGIC) {
+            std::cerr << "Error opening shared memory ring " << name << ": not initialised" << std::endl;
+            return false;
+        }
+        // The geometry of an existing ring wins over the configuration
+        _config.slot_size = header->slot_size;
+        slot_stride = (sizeof(Slot) + _config.slot_size + 63) & ~static_cast<size_t>(63);
+    }
+
+    _config.slot_count = header->slot_count;
+    slots = reinterpret_cast<uint8_t*>(header) + sizeof(RingHeader);
+    return true;
+}
+
+// Method returning the slot of a ticket
+ShmEngine::Slot* ShmEngine::slot(uint64_t ticket) const {
+    return reinterpret_cast<Slot*>(slots + (ticket & (_config.slot_count - 1)) * slot_stride);
+}
+
+// Method to publish an Ethernet frame in the ring
+int ShmEngine::send(const void* data, size_t size) {
+    if (size > _config.slot_size) {
+        std::cerr << "Error sending Ethernet frame: " << size << " bytes exceed the ring slot size" << std::endl;
+        return -1;
+    }
+
+    uint64_t ticket = __atomic_fetch_add(&header->reserve, 1, __ATOMIC_ACQ_REL);
+    Slot* s = slot(ticket);
+
+    // A sender one lap behind may still be writing this slot; a bounded wait
+    // keeps a process that died mid-write from blocking the ring forever
+    if (ticket >= _config.slot_count) {
+        uint64_t previous = 2 * (ticket - _config.slot_count) + 2;
+        for (int attempt = 0; __atomic_load_n(&s->sequence, __ATOMIC_ACQUIRE) < previous && attempt < 10000; ++attempt) {
+            sched_yield();
+        }
+    }
+
+    __atomic_store_n(&s->sequence, 2 * ticket + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    s->sender = _id;
+    s->size = static_cast<uint32_t>(size);
+    std::memcpy(reinterpret_cast<uint8_t*>(s) + sizeof(Slot), data, size);
+    __atomic_store_n(&s->sequence, 2 * ticket + 2, __ATOMIC_RELEASE);
+    frames_sent++;
+
+    // Wake sleeping readers (the counter change also defeats a wait that is about to start)
+    __atomic_fetch_add(&header->futex, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&header->waiters, __ATOMIC_SEQ_CST) > 0) {
+        futex(&header->futex, FUTEX_WAKE, INT_MAX, nullptr);
+    }
+    return static_cast<int>(size);
+}
+
+// Method delivering every frame published after the cursor; returns false if there was none
+bool ShmEngine::receive_pending() {
+    uint8_t buffer[2048];
+    bool progress = false;
+
+    while (true) {
+        Slot* s = slot(cursor);
+        uint64_t expected = 2 * cursor + 2;
+        uint64_t sequence = __atomic_load_n(&s->sequence, __ATOMIC_ACQUIRE);
+        if (sequence < expected) {
+            break;  // Not published yet
+        }
+        if (sequence > expected) {
+            // Lapped: jump to the oldest frame still in the ring
+            uint64_t reserve = __atomic_load_n(&header->reserve, __ATOMIC_ACQUIRE);
+            uint64_t oldest = (reserve > _config.slot_count) ? reserve - _config.slot_count : 0;
+            uint64_t next = std::max(oldest, cursor + 1);
+            frames_overrun += next - cursor;
+            cursor = next;
+            progress = true;
+            continue;
+        }
+
+        // Copy the frame out and check that no sender overwrote it meanwhile
+        uint64_t sender = s->sender;
+        size_t size = std::min<size_t>(s->size, std::min<size_t>(_config.slot_size, sizeof(buffer)));
+        std::memcpy(buffer, reinterpret_cast<uint8_t*>(s) + sizeof(Slot), size);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&s->sequence, __ATOMIC_RELAXED) != expected) {
+            continue;  // Overwritten: handled as a lap on the next iteration
+        }
+        cursor++;
+        progress = true;
+        frames_received++;
+
+        if (sender == _id || size < 14 || !_callback) {
+            continue;
+        }
+        bool accepted;
+        {
+            std::lock_guard<std::mutex> lock(filter_mutex);
+            accepted = filter.matches(buffer, size);
+        }
+        if (accepted) {
+            _callback(buffer, size);
+        }
+    }
+    return progress;
+}
+
+// Method run by the reader thread
+void ShmEngine::receive_loop() {
+    // 10 ms sleeps; a slot left unpublished for 100 ms (its sender died) is skipped.
+    // The stall is timed, not counted: frames of other senders may wake the reader
+    // many times while it waits for the stuck slot.
+    const struct timespec timeout {0, 10 * 1000 * 1000};
+    const std::chrono::milliseconds stall_limit(100);
+    bool stalled = false;
+    std::chrono::steady_clock::time_point stall_deadline;
+
+    while (running) {
+        if (receive_pending()) {
+            stalled = false;
+            continue;
+        }
+
+        uint32_t seen = __atomic_load_n(&header->futex, __ATOMIC_SEQ_CST);
+        __atomic_fetch_add(&header->waiters, 1, __ATOMIC_SEQ_CST);
+        bool progress = receive_pending();
+        if (!progress && running) {
+            futex(&header->futex, FUTEX_WAIT, seen, &timeout);
+        }
+        __atomic_fetch_sub(&header->waiters, 1, __ATOMIC_SEQ_CST);
+
+        if (progress || __atomic_load_n(&header->reserve, __ATOMIC_ACQUIRE) <= cursor) {
+            stalled = false;
+        } else if (!stalled) {
+            stalled = true;
+            stall_deadline = std::chrono::steady_clock::now() + stall_limit;
+        } else if (std::chrono::steady_clock::now() >= stall_deadline) {
+            cursor++;
+            frames_overrun++;
+            stalled = false;
+        }
+    }
+}
+
+// Method to open a transmit batch
+void ShmEngine::begin_batch() {}
+
+// Method to close a transmit batch
+int ShmEngine::end_batch() {
+    return 0;
+}
+
+// Method to send every queued frame
+int ShmEngine::flush() {
+    return 0;
+}
+
+// Method building the receive filter described by the configuration
+SocketFilter ShmEngine::default_filter() const {
+    SocketFilter filter;
+    filter.accept_broadcast();
+    if (_config.protocol_filter != 0) {
+        filter.accept_protocol(_config.protocol_filter);
+    }
+    return filter;
+}
+
+// Method to replace the receive filter
+bool ShmEngine::set_filter(const SocketFilter& new_filter) {
+    std::lock_guard<std::mutex> lock(filter_mutex);
+    filter = new_filter;
+    return true;
+}
+
+// Method returning the counters of the engine
+ShmEngine::Statistics ShmEngine::statistics() const {
+    Statistics stats;
+    stats.frames_sent = frames_sent;
+    stats.frames_received = frames_received;
+    stats.frames_overrun = frames_overrun;
+    return stats;
+}
+
+// Method to remove the shared memory object of a ring
+bool ShmEngine::unlink(const std::string& interface) {
+    return shm_unlink(object_name(interface).c_str()) == 0;
+}
@@ -0,0 +1,274 @@
+#include "../include/sim_engine.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <queue>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+// In-memory broadcast medium shared by the SimEngines with the same interface name
+class SimEngine::Bus {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Bus(const Config& config) : medium(config), random(std::random_device{}()), loss_random(std::random_device{}()) {
+        delivery_thread = std::thread(&Bus::run, this);
+    }
+
+    ~Bus() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stop = true;
+        }
+        queue_cv.notify_all();
+        delivery_thread.join();
+    }
+
+    // Returns the bus with the given name, creating it on first use
+    static std::shared_ptr<Bus> open(const std::string& name, const Config& config) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        std::shared_ptr<Bus> bus = registry[name].lock();
+        if (!bus) {
+            auto medium = media.find(name);
+            bus = std::make_shared<Bus>(medium != media.end() ? medium->second : config);
+            registry[name] = bus;
+        }
+        return bus;
+    }
+
+    // Returns the bus with the given name if some engine is using it
+    static std::shared_ptr<Bus> find(const std::string& name) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        auto it = registry.find(name);
+        return (it != registry.end()) ? it->second.lock() : nullptr;
+    }
+
+    static void set_medium(const std::string& name, const Config& config) {
+        std::shared_ptr<Bus> bus;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            media[name] = config;
+            bus = registry[name].lock();
+        }
+        if (bus) {
+            std::lock_guard<std::mutex> lock(bus->queue_mutex);
+            bus->medium = config;
+        }
+    }
+
+    // Adds an engine, giving it the id that marks its frames
+    void attach(SimEngine* engine) {
+        std::unique_lock<std::shared_mutex> lock(members_mutex);
+        engine->_id = next_id++;
+        if (engine->_receive) {
+            members.push_back(engine);
+        }
+    }
+
+    // Removes an engine, waiting for a delivery in progress to finish
+    void detach(SimEngine* engine) {
+        std::unique_lock<std::shared_mutex> lock(members_mutex);
+        members.erase(std::remove(members.begin(), members.end(), engine), members.end());
+    }
+
+    // Queues a frame, computing when it reaches the receivers
+    void send(SimEngine* sender, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        std::vector<uint8_t> frame(bytes, bytes + size);
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            Clock::time_point now = Clock::now();
+            Clock::time_point due = now;
+
+            // The medium carries one frame at a time at the configured bit rate
+            if (medium.bandwidth_bps > 0) {
+                medium_free = std::max(medium_free, now) +
+                    std::chrono::nanoseconds(size * 8 * 1000000000ULL / medium.bandwidth_bps);
+                due = medium_free;
+            }
+            due += std::chrono::microseconds(medium.latency_us);
+            if (medium.jitter_us > 0) {
+                due += std::chrono::microseconds(std::uniform_int_distribution<unsigned int>(0, medium.jitter_us)(random));
+            }
+            // Jitter never reorders the frames of one sender
+            due = std::max(due, sender->last_due);
+            sender->last_due = due;
+
+            queue.push({due, next_sequence++, sender->_id, std::move(frame)});
+            stats.frames_sent++;
+        }
+        queue_cv.notify_one();
+    }
+
+    Statistics statistics() {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        return stats;
+    }
+
+private:
+    struct Pending {
+        Clock::time_point due;
+        uint64_t sequence;
+        uint64_t sender;
+        std::vector<uint8_t> data;
+
+        // Earliest delivery first, send order between equal times
+        bool operator>(const Pending& other) const {
+            return due != other.due ? due > other.due : sequence > other.sequence;
+        }
+    };
+
+    // Delivery thread: hands every due frame to the receivers
+    void run() {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        while (true) {
+            if (stop) {
+                break;
+            }
+            if (queue.empty()) {
+                queue_cv.wait(lock);
+                continue;
+            }
+            if (queue.top().due > Clock::now()) {
+                // Copied: a send may reallocate the queue while this thread waits
+                Clock::time_point due = queue.top().due;
+                queue_cv.wait_until(lock, due);
+                continue;
+            }
+
+            Pending frame = std::move(const_cast<Pending&>(queue.top()));
+            queue.pop();
+            double loss = medium.loss;
+            lock.unlock();
+
+            uint64_t delivered = 0, lost = 0, filtered = 0;
+            {
+                std::shared_lock<std::shared_mutex> members_lock(members_mutex);
+                for (SimEngine* member : members) {
+                    if (member->_id == frame.sender) {
+                        continue;
+                    }
+                    if (loss > 0.0 && loss_distribution(loss_random) < loss) {
+                        lost++;
+                    } else if (member->deliver(frame.data.data(), frame.data.size())) {
+                        delivered++;
+                    } else {
+                        filtered++;
+                    }
+                }
+            }
+
+            lock.lock();
+            stats.frames_delivered += delivered;
+            stats.frames_lost += lost;
+            stats.frames_filtered += filtered;
+        }
+    }
+
+    static std::mutex registry_mutex;
+    static std::map<std::string, std::weak_ptr<Bus>> registry;
+    static std::map<std::string, Config> media;
+
+    // Frames in flight and medium state
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> queue;
+    Config medium;
+    Clock::time_point medium_free {};
+    uint64_t next_sequence = 0;
+    Statistics stats;
+    bool stop = false;
+    std::mt19937_64 random;                 // Jitter, drawn under queue_mutex
+    std::mt19937_64 loss_random;            // Loss, drawn by the delivery thread only
+    std::uniform_real_distribution<double> loss_distribution {0.0, 1.0};
+
+    // Receiving engines
+    std::shared_mutex members_mutex;
+    std::vector<SimEngine*> members;
+    uint64_t next_id = 1;
+
+    std::thread delivery_thread;
+};
+
+std::mutex SimEngine::Bus::registry_mutex;
+std::map<std::string, std::weak_ptr<SimEngine::Bus>> SimEngine::Bus::registry;
+std::map<std::string, SimEngine::Config> SimEngine::Bus::media;
+
+// Constructor
+SimEngine::SimEngine(const std::string& interface, Callback callback, bool enable_receive)
+    : SimEngine(interface, callback, enable_receive, Config()) {}
+
+// Constructor with explicit configuration
+SimEngine::SimEngine(const std::string& interface, Callback callback, bool enable_receive, const Config& config)
+    : _interface(interface), _callback(callback), _config(config), _receive(enable_receive && callback != nullptr) {
+    filter = default_filter();
+    bus = Bus::open(interface, config);
+    bus->attach(this);
+}
+
+// Destructor
+SimEngine::~SimEngine() {
+    // Once detached the delivery thread no longer calls this engine
+    bus->detach(this);
+}
+
+// Method to send an Ethernet frame to every other engine of the bus
+int SimEngine::send(const void* data, size_t size) {
+    bus->send(this, data, size);
+    return static_cast<int>(size);
+}
+
+// Method to open a transmit batch
+void SimEngine::begin_batch() {}
+
+// Method to close a transmit batch
+int SimEngine::end_batch() {
+    return 0;
+}
+
+// Method to send every queued frame
+int SimEngine::flush() {
+    return 0;
+}
+
+// Method building the receive filter described by the configuration
+SocketFilter SimEngine::default_filter() const {
+    SocketFilter filter;
+    filter.accept_broadcast();
+    if (_config.protocol_filter != 0) {
+        filter.accept_protocol(_config.protocol_filter);
+    }
+    return filter;
+}
+
+// Method to replace the receive filter
+bool SimEngine::set_filter(const SocketFilter& new_filter) {
+    std::lock_guard<std::mutex> lock(filter_mutex);
+    filter = new_filter;
+    return true;
+}
+
+// Method delivering one frame of the bus to the callback
+bool SimEngine::deliver(const uint8_t* frame, size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(filter_mutex);
+        if (size < 14 || !filter.matches(frame, size)) {
+            return false;
+        }
+    }
+    _callback(frame, size);
+    return true;
+}
+
+// Method to set the medium of a bus
+void SimEngine::set_medium(const std::string& interface, const Config& config) {
+    Bus::set_medium(interface, config);
+}
+
+// Method returning the counters of a bus
+SimEngine::Statistics SimEngine::statistics(const std::string& interface) {
+    std::shared_ptr<Bus> bus = Bus::find(interface);
+    return bus ? bus->statistics() : Statistics();
+}
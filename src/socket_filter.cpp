@@ -0,0 +1,157 @@
+#include "../include/socket_filter.hpp"
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <sys/socket.h>
+#include <linux/filter.h>
+#include <linux/if_packet.h>
+
+// Offset of the ancillary load that yields the packet type
+static constexpr uint32_t PKTTYPE_OFFSET = static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_PKTTYPE);
+
+// Method to accept only broadcast frames
+SocketFilter& SocketFilter::accept_broadcast() {
+    return require(0, {Bytes(6, 0xFF)});
+}
+
+// Method to accept only one EtherType
+SocketFilter& SocketFilter::accept_protocol(uint16_t protocol) {
+    return require(12, {Bytes{static_cast<uint8_t>(protocol >> 8), static_cast<uint8_t>(protocol & 0xFF)}});
+}
+
+// Method to drop frames sent from this host
+SocketFilter& SocketFilter::drop_outgoing() {
+    return exclude(PKTTYPE_OFFSET, Bytes{0, 0, 0, PACKET_OUTGOING});
+}
+
+// Method to drop frames from one source MAC
+SocketFilter& SocketFilter::drop_source(const uint8_t* mac) {
+    return exclude(6, Bytes(mac, mac + 6));
+}
+
+// Method to require one of several values at an offset
+SocketFilter& SocketFilter::require(uint32_t offset, std::initializer_list<Bytes> values) {
+    return require(offset, std::vector<Bytes>(values));
+}
+
+// Method to require one of several values at an offset
+SocketFilter& SocketFilter::require(uint32_t offset, const std::vector<Bytes>& values) {
+    rules.push_back({offset, values, false});
+    return *this;
+}
+
+// Method to drop frames with a value at an offset
+SocketFilter& SocketFilter::exclude(uint32_t offset, const Bytes& value) {
+    rules.push_back({offset, {value}, true});
+    return *this;
+}
+
+// Method to evaluate the rules in user space
+bool SocketFilter::matches(const uint8_t* frame, size_t size, int pkttype) const {
+    uint8_t pkttype_bytes[4] = {0, 0, 0, static_cast<uint8_t>(pkttype)};
+
+    for (const Rule& rule : rules) {
+        bool matched = false;
+        for (const Bytes& value : rule.values) {
+            const uint8_t* field = nullptr;
+            if (rule.offset == PKTTYPE_OFFSET) {
+                field = (value.size() == 4) ? pkttype_bytes : nullptr;
+            } else if (rule.offset + value.size() <= size) {
+                field = frame + rule.offset;
+            }
+            if (field != nullptr && std::memcmp(field, value.data(), value.size()) == 0) {
+                matched = true;
+                break;
+            }
+        }
+        if (matched == rule.exclude) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Method to compile the rules into a classic BPF program and attach it
+bool SocketFilter::attach(int socket) const {
+    std::vector<struct sock_filter> code;
+
+    // Jumps to labels are patched once every label position is known
+    struct Fixup {
+        size_t pc;
+        size_t label;
+        bool conditional;
+    };
+    std::vector<Fixup> fixups;
+    std::vector<size_t> labels;
+    auto new_label = [&]() { labels.push_back(0); return labels.size() - 1; };
+    auto place = [&](size_t label) { labels[label] = code.size(); };
+    auto jump = [&](size_t label) {
+        fixups.push_back({code.size(), label, false});
+        code.push_back(BPF_STMT(BPF_JMP | BPF_JA, 0));
+    };
+
+    const size_t reject = new_label();
+
+    // Emits the comparison of one value; a mismatch jumps to 'fail'
+    auto compare = [&](uint32_t offset, const Bytes& value, size_t fail) {
+        size_t i = 0;
+        while (i < value.size()) {
+            size_t remaining = value.size() - i;
+            uint16_t width = (remaining >= 4) ? BPF_W : (remaining >= 2) ? BPF_H : BPF_B;
+            size_t length = (width == BPF_W) ? 4 : (width == BPF_H) ? 2 : 1;
+            uint32_t k = 0;
+            for (size_t j = 0; j < length; ++j) {
+                k = (k << 8) | value[i + j];
+            }
+            code.push_back(BPF_STMT(BPF_LD | width | BPF_ABS, offset + static_cast<uint32_t>(i)));
+            fixups.push_back({code.size(), fail, true});
+            code.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, k, 0, 0));
+            i += length;
+        }
+    };
+
+    for (const Rule& rule : rules) {
+        size_t rule_end = new_label();
+        if (rule.exclude) {
+            // Match: reject; mismatch: next rule
+            compare(rule.offset, rule.values.front(), rule_end);
+            jump(reject);
+        } else {
+            // Each alternative falls through to the next one on mismatch
+            for (const Bytes& value : rule.values) {
+                size_t next = new_label();
+                compare(rule.offset, value, next);
+                jump(rule_end);
+                place(next);
+            }
+            jump(reject);
+        }
+        place(rule_end);
+    }
+
+    code.push_back(BPF_STMT(BPF_RET | BPF_K, 0x40000)); // Accept the whole frame
+    place(reject);
+    code.push_back(BPF_STMT(BPF_RET | BPF_K, 0));       // Drop the frame
+
+    for (const Fixup& fixup : fixups) {
+        size_t offset = labels[fixup.label] - (fixup.pc + 1);
+        if (fixup.conditional) {
+            if (offset > 255) {
+                std::cerr << "Socket filter too large: jump offset " << offset << " > 255" << std::endl;
+                return false;
+            }
+            code[fixup.pc].jf = static_cast<uint8_t>(offset);
+        } else {
+            code[fixup.pc].k = static_cast<uint32_t>(offset);
+        }
+    }
+
+    struct sock_fprog program {};
+    program.len = static_cast<unsigned short>(code.size());
+    program.filter = code.data();
+    if (setsockopt(socket, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) < 0) {
+        perror("Error attaching socket filter");
+        return false;
+    }
+    return true;
+}
@@ -1,16 +1,26 @@
 #include "../include/vehicle.hpp"
 
 // Construtor: inicializa o nome do veículo, a NIC e o protocolo
-Veiculo::Veiculo(const std::string& interface, const std::string& nome)
-    : nome(nome), nic(interface), protocolo(&nic, &data_publisher, 0x88B5, &rsu_handler, &time_sync_manager),
-        time_sync_manager(&data_publisher, &protocolo, nic.get_address()),
-        rsu_handler(&data_publisher, &time_sync_manager, &protocolo, nic.get_address()) {}
+Veiculo::Veiculo(const std::string& interface, const std::string& nome, unsigned int threads_executor)
+    : Veiculo(std::make_unique<NIC<Engine>>(interface), nome, threads_executor) {}
+
+// Construtor com uma NIC já criada
+Veiculo::Veiculo(std::unique_ptr<NIC_Base> nic, const std::string& nome, unsigned int threads_executor)
+    : nome(nome), nic(std::move(nic)), protocolo(this->nic.get(), &data_publisher, 0x88B5, &rsu_handler, &time_sync_manager),
+        time_sync_manager(&data_publisher, &protocolo, this->nic->get_address()),
+        rsu_handler(&data_publisher, &time_sync_manager, &protocolo, this->nic->get_address()),
+        executor(threads_executor) {}
 
 // Destrutor: espera todas as threads terminarem antes de destruir o objeto
 Veiculo::~Veiculo() {
     for (auto& thread : threads) {
         pthread_join(thread, nullptr); // Aguarda cada thread finalizar
     }
+    // Desinscreve e destrói os componentes assíncronos (cada um espera seus handlers pendentes)
+    for (auto& componente : componentes_assincronos) {
+        data_publisher.unsubscribe(componente->getObserver());
+    }
+    componentes_assincronos.clear();
 }
 
 // Método para criar uma nova thread componente
@@ -20,7 +30,7 @@ Veiculo::~Veiculo() {
 bool Veiculo::criar_componente(const std::string nome, funcao func_rotina) {
     pthread_t thread_id;
     // Aloca os dados que serão passados para a thread
-    DadosComponente* dados = new DadosComponente{&data_publisher, &protocolo, nome, nic.get_address()};
+    DadosComponente* dados = new DadosComponente{&data_publisher, &protocolo, nome, nic->get_address()};
 
     // Cria a thread, executando func_rotina com os dados como argumento
     int ret = pthread_create(&thread_id, nullptr, func_rotina, dados);
@@ -31,3 +41,14 @@ bool Veiculo::criar_componente(const std::string nome, funcao func_rotina) {
     threads.push_back(thread_id); // Guarda o ID da thread para poder esperar o término depois
     return true;
 }
+
+// Método para criar um componente assíncrono
+// Cria o comunicador do componente e chama 'iniciar' para registrar seus handlers
+AsyncCommunicator* Veiculo::criar_componente_assincrono(const std::string nome, funcao_assincrona iniciar,
+                                                        const Concurrent_Observer::Config& fila) {
+    componentes_assincronos.push_back(std::make_unique<AsyncCommunicator>(&protocolo, nic->get_address(), &executor, fila));
+    AsyncCommunicator* comunicador = componentes_assincronos.back().get();
+    DadosComponente dados{&data_publisher, &protocolo, nome, nic->get_address()};
+    iniciar(*comunicador, dados);
+    return comunicador;
+}
@@ -0,0 +1,407 @@
+#include "../include/xdp_engine.hpp"
+#include "../include/reactor.hpp"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+#include <sched.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+// There is no libbpf in the build, so the XDP program is loaded with the raw bpf() syscall
+static int sys_bpf(int cmd, union bpf_attr* attr) {
+    return static_cast<int>(syscall(__NR_bpf, cmd, attr, sizeof(*attr)));
+}
+
+static struct bpf_insn bpf_instruction(uint8_t code, uint8_t dst, uint8_t src, int16_t off, int32_t imm) {
+    struct bpf_insn insn {};
+    insn.code = code;
+    insn.dst_reg = dst & 0x0F;
+    insn.src_reg = src & 0x0F;
+    insn.off = off;
+    insn.imm = imm;
+    return insn;
+}
+
+// Constructor
+XdpEngine::XdpEngine(const std::string& interface, Callback callback, bool enable_receive)
+    : XdpEngine(interface, callback, enable_receive, Config()) {}
+
+// Constructor with explicit configuration
+XdpEngine::XdpEngine(const std::string& interface, Callback callback, bool enable_receive, const Config& config)
+    : _interface(interface), _callback(callback), _config(config) {
+    _ifindex = static_cast<int>(if_nametoindex(interface.c_str()));
+    if (_ifindex == 0) {
+        perror("Error getting interface index");
+        exit(EXIT_FAILURE);
+    }
+    filter = default_filter();
+
+    // UMEM shared by both directions
+    umem_size = static_cast<size_t>(_config.frame_count) * _config.frame_size;
+    void* area = mmap(nullptr, umem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (area == MAP_FAILED) {
+        perror("Error allocating UMEM");
+        exit(EXIT_FAILURE);
+    }
+    umem = static_cast<uint8_t*>(area);
+
+    _socket = socket(AF_XDP, SOCK_RAW, 0);
+    if (_socket < 0) {
+        perror("Error creating AF_XDP socket");
+        exit(EXIT_FAILURE);
+    }
+
+    struct xdp_umem_reg reg {};
+    reg.addr = reinterpret_cast<uint64_t>(umem);
+    reg.len = umem_size;
+    reg.chunk_size = _config.frame_size;
+    reg.headroom = 0;
+    if (setsockopt(_socket, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) < 0) {
+        perror("Error registering UMEM");
+        exit(EXIT_FAILURE);
+    }
+
+    // Size the four rings and map them into the process
+    unsigned int ring_size = _config.ring_size;
+    if (setsockopt(_socket, SOL_XDP, XDP_UMEM_FILL_RING, &ring_size, sizeof(ring_size)) < 0 ||
+        setsockopt(_socket, SOL_XDP, XDP_UMEM_COMPLETION_RING, &ring_size, sizeof(ring_size)) < 0 ||
+        setsockopt(_socket, SOL_XDP, XDP_RX_RING, &ring_size, sizeof(ring_size)) < 0 ||
+        setsockopt(_socket, SOL_XDP, XDP_TX_RING, &ring_size, sizeof(ring_size)) < 0) {
+        perror("Error sizing AF_XDP rings");
+        exit(EXIT_FAILURE);
+    }
+
+    struct xdp_mmap_offsets offsets {};
+    socklen_t length = sizeof(offsets);
+    if (getsockopt(_socket, SOL_XDP, XDP_MMAP_OFFSETS, &offsets, &length) < 0) {
+        perror("Error reading AF_XDP ring offsets");
+        exit(EXIT_FAILURE);
+    }
+    if (!map_ring(fill_ring, offsets.fr, XDP_UMEM_PGOFF_FILL_RING, sizeof(uint64_t)) ||
+        !map_ring(completion_ring, offsets.cr, XDP_UMEM_PGOFF_COMPLETION_RING, sizeof(uint64_t)) ||
+        !map_ring(rx_ring, offsets.rx, XDP_PGOFF_RX_RING, sizeof(struct xdp_desc)) ||
+        !map_ring(tx_ring, offsets.tx, XDP_PGOFF_TX_RING, sizeof(struct xdp_desc))) {
+        exit(EXIT_FAILURE);
+    }
+
+    // First half of the frames belongs to RX: hand as many as fit to the kernel
+    unsigned int rx_frames = _config.frame_count / 2;
+    uint32_t fill_count = std::min(rx_frames, fill_ring.size);
+    auto* fill_addrs = static_cast<uint64_t*>(fill_ring.descs);
+    for (uint32_t i = 0; i < fill_count; ++i) {
+        fill_addrs[i] = static_cast<uint64_t>(i) * _config.frame_size;
+    }
+    __atomic_store_n(fill_ring.producer, fill_count, __ATOMIC_RELEASE);
+
+    // Second half belongs to TX
+    for (unsigned int i = rx_frames; i < _config.frame_count; ++i) {
+        tx_free.push_back(static_cast<uint64_t>(i) * _config.frame_size);
+    }
+
+    struct sockaddr_xdp addr {};
+    addr.sxdp_family = AF_XDP;
+    addr.sxdp_ifindex = static_cast<uint32_t>(_ifindex);
+    addr.sxdp_queue_id = _config.queue_id;
+    addr.sxdp_flags = _config.zero_copy ? XDP_ZEROCOPY : XDP_COPY;
+    if (bind(_socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        perror("Error binding AF_XDP socket to interface");
+        exit(EXIT_FAILURE);
+    }
+
+    // Redirect the protocol frames of the queue to the socket and register it in the shared reactor
+    if (enable_receive) {
+        if (!load_program()) {
+            exit(EXIT_FAILURE);
+        }
+        Reactor::reserve_threads(1);
+        _reactor_id = Reactor::instance().add(_socket, [this]() { receive_ring(); });
+    }
+}
+
+// Destructor
+XdpEngine::~XdpEngine() {
+    // Stop receiving before the program is detached and the rings unmapped
+    if (_reactor_id != 0) {
+        Reactor::instance().remove(_reactor_id);
+    }
+    if (link_fd >= 0) {
+        close(link_fd);
+    }
+    if (prog_fd >= 0) {
+        close(prog_fd);
+    }
+    if (map_fd >= 0) {
+        close(map_fd);
+    }
+    unmap_ring(fill_ring);
+    unmap_ring(completion_ring);
+    unmap_ring(rx_ring);
+    unmap_ring(tx_ring);
+    if (_socket >= 0) {
+        close(_socket);
+    }
+    if (umem != nullptr) {
+        munmap(umem, umem_size);
+    }
+}
+
+// Method to map one of the rings shared with the kernel
+bool XdpEngine::map_ring(Ring& ring, const struct xdp_ring_offset& offset, uint64_t pgoff, size_t desc_size) {
+    ring.size = _config.ring_size;
+    ring.map_size = offset.desc + ring.size * desc_size;
+    void* map = mmap(nullptr, ring.map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _socket, static_cast<off_t>(pgoff));
+    if (map == MAP_FAILED) {
+        perror("Error mapping AF_XDP ring");
+        ring.map_size = 0;
+        return false;
+    }
+    ring.map = map;
+    ring.producer = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(map) + offset.producer);
+    ring.consumer = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(map) + offset.consumer);
+    ring.descs = static_cast<uint8_t*>(map) + offset.desc;
+    return true;
+}
+
+// Method to release a mapped ring
+void XdpEngine::unmap_ring(Ring& ring) {
+    if (ring.map != nullptr) {
+        munmap(ring.map, ring.map_size);
+        ring.map = nullptr;
+    }
+}
+
+// Method to load and attach the XDP program that redirects the protocol frames to the socket
+bool XdpEngine::load_program() {
+    // XSKMAP slot per queue, the socket sits at its own queue index
+    union bpf_attr attr {};
+    attr.map_type = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size = sizeof(uint32_t);
+    attr.value_size = sizeof(uint32_t);
+    attr.max_entries = _config.queue_id + 1;
+    map_fd = sys_bpf(BPF_MAP_CREATE, &attr);
+    if (map_fd < 0) {
+        perror("Error creating XSKMAP");
+        return false;
+    }
+
+    uint32_t key = _config.queue_id;
+    uint32_t value = static_cast<uint32_t>(_socket);
+    attr = {};
+    attr.map_fd = static_cast<uint32_t>(map_fd);
+    attr.key = reinterpret_cast<uint64_t>(&key);
+    attr.value = reinterpret_cast<uint64_t>(&value);
+    if (sys_bpf(BPF_MAP_UPDATE_ELEM, &attr) < 0) {
+        perror("Error inserting AF_XDP socket in XSKMAP");
+        return false;
+    }
+
+    // The EtherType is compared as loaded from the frame, i.e. in network byte order
+    const int32_t protocol = htons(_config.protocol);
+    const struct bpf_insn program[] = {
+        bpf_instruction(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_6, BPF_REG_1, 0, 0),          // r6 = ctx
+        bpf_instruction(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_6, 0, 0),            // r2 = ctx->data
+        bpf_instruction(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_3, BPF_REG_6, 4, 0),            // r3 = ctx->data_end
+        bpf_instruction(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_4, BPF_REG_2, 0, 0),
+        bpf_instruction(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_4, 0, 0, 14),
+        bpf_instruction(BPF_JMP | BPF_JGT | BPF_X, BPF_REG_4, BPF_REG_3, 8, 0),            // short frame: pass
+        bpf_instruction(BPF_LDX | BPF_MEM | BPF_H, BPF_REG_4, BPF_REG_2, 12, 0),           // r4 = EtherType
+        bpf_instruction(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_4, 0, 6, protocol),             // other protocol: pass
+        bpf_instruction(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_6, 16, 0),           // r2 = ctx->rx_queue_index
+        bpf_instruction(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, map_fd),
+        bpf_instruction(0, 0, 0, 0, 0),
+        bpf_instruction(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, XDP_PASS),           // fallback action
+        bpf_instruction(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map),
+        bpf_instruction(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+        bpf_instruction(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_0, 0, 0, XDP_PASS),           // pass:
+        bpf_instruction(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+    };
+
+    static const char license[] = "GPL";
+    char log[4096] = {};
+    attr = {};
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = reinterpret_cast<uint64_t>(program);
+    attr.insn_cnt = sizeof(program) / sizeof(program[0]);
+    attr.license = reinterpret_cast<uint64_t>(license);
+    attr.log_buf = reinterpret_cast<uint64_t>(log);
+    attr.log_size = sizeof(log);
+    attr.log_level = 1;
+    prog_fd = sys_bpf(BPF_PROG_LOAD, &attr);
+    if (prog_fd < 0) {
+        perror("Error loading XDP program");
+        std::cerr << log << std::endl;
+        return false;
+    }
+
+    // Generic (SKB) mode matches the copy mode of the socket and works on any driver
+    attr = {};
+    attr.link_create.prog_fd = static_cast<uint32_t>(prog_fd);
+    attr.link_create.target_ifindex = static_cast<uint32_t>(_ifindex);
+    attr.link_create.attach_type = BPF_XDP;
+    attr.link_create.flags = _config.zero_copy ? XDP_FLAGS_DRV_MODE : XDP_FLAGS_SKB_MODE;
+    link_fd = sys_bpf(BPF_LINK_CREATE, &attr);
+    if (link_fd < 0) {
+        perror("Error attaching XDP program to interface");
+        return false;
+    }
+    return true;
+}
+
+// Method building the receive filter described by the configuration
+SocketFilter XdpEngine::default_filter() const {
+    SocketFilter filter;
+    filter.accept_broadcast();
+    if (_config.protocol != 0) {
+        filter.accept_protocol(_config.protocol);
+    }
+    return filter;
+}
+
+// Method to replace the receive filter
+bool XdpEngine::set_filter(const SocketFilter& new_filter) {
+    std::lock_guard<std::mutex> lock(filter_mutex);
+    filter = new_filter;
+    return true;
+}
+
+// Method delivering every frame in the RX ring and recycling the frames to the fill ring
+void XdpEngine::receive_ring() {
+    auto* descs = static_cast<struct xdp_desc*>(rx_ring.descs);
+    auto* fill_addrs = static_cast<uint64_t*>(fill_ring.descs);
+    const uint32_t mask = rx_ring.size - 1;
+    const uint64_t chunk_mask = ~static_cast<uint64_t>(_config.frame_size - 1);
+
+    while (true) {
+        uint32_t consumer = *rx_ring.consumer;
+        uint32_t producer = __atomic_load_n(rx_ring.producer, __ATOMIC_ACQUIRE);
+        if (consumer == producer) {
+            break;
+        }
+
+        // The fill ring has room for every frame taken from the RX ring (both hold the RX half at most)
+        uint32_t fill_producer = *fill_ring.producer;
+        std::lock_guard<std::mutex> lock(filter_mutex);
+        for (; consumer != producer; ++consumer) {
+            const struct xdp_desc& desc = descs[consumer & mask];
+            const uint8_t* frame = umem + desc.addr;
+            if (desc.len >= 14 && filter.matches(frame, desc.len) && _callback) {
+                _callback(frame, desc.len);
+            }
+            fill_addrs[fill_producer++ & (fill_ring.size - 1)] = desc.addr & chunk_mask;
+        }
+        __atomic_store_n(rx_ring.consumer, consumer, __ATOMIC_RELEASE);
+        __atomic_store_n(fill_ring.producer, fill_producer, __ATOMIC_RELEASE);
+    }
+}
+
+// Method returning the frames the kernel has finished sending to the TX pool (tx_mutex must be held)
+void XdpEngine::reclaim_completed() {
+    auto* addrs = static_cast<uint64_t*>(completion_ring.descs);
+    uint32_t consumer = *completion_ring.consumer;
+    uint32_t producer = __atomic_load_n(completion_ring.producer, __ATOMIC_ACQUIRE);
+    for (; consumer != producer; ++consumer) {
+        tx_free.push_back(addrs[consumer & (completion_ring.size - 1)]);
+    }
+    __atomic_store_n(completion_ring.consumer, consumer, __ATOMIC_RELEASE);
+}
+
+// Method waking the kernel to transmit the pending descriptors (tx_mutex must be held)
+int XdpEngine::kick_locked() {
+    if (tx_pending == 0) {
+        return 0;
+    }
+    // In copy mode each wakeup transmits a bounded number of descriptors, so
+    // keep waking the kernel until it has consumed the whole TX ring
+    int sent = static_cast<int>(tx_pending);
+    for (int attempt = 0; __atomic_load_n(tx_ring.consumer, __ATOMIC_ACQUIRE) != *tx_ring.producer; ++attempt) {
+        if (::sendto(_socket, nullptr, 0, MSG_DONTWAIT, nullptr, 0) < 0 &&
+            errno != EINTR && errno != EAGAIN && errno != EBUSY && errno != ENOBUFS) {
+            perror("Error sending AF_XDP frames");
+            sent = -1;
+            break;
+        }
+        if (attempt == 1000) {
+            // Left in the ring, the next kick continues from here
+            break;
+        }
+    }
+    tx_pending = 0;
+    reclaim_completed();
+    return sent;
+}
+
+// Method to send an Ethernet frame (the kernel is woken at once unless a batch is open)
+int XdpEngine::send(const void* data, size_t size) {
+    if (size > _config.frame_size) {
+        std::cerr << "Error sending AF_XDP frame: " << size << " bytes exceed the UMEM frame size" << std::endl;
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    reclaim_completed();
+
+    // Wait for a free frame and ring slot, kicking the kernel so that it completes pending ones
+    for (int attempt = 0; tx_free.empty() ||
+         *tx_ring.producer - __atomic_load_n(tx_ring.consumer, __ATOMIC_ACQUIRE) >= tx_ring.size; ++attempt) {
+        if (attempt == 1000) {
+            std::cerr << "Error sending AF_XDP frame: TX ring full" << std::endl;
+            return -1;
+        }
+        tx_pending = std::max<uint32_t>(tx_pending, 1);
+        kick_locked();
+        if (attempt > 0) {
+            sched_yield();
+        }
+    }
+
+    uint64_t addr = tx_free.back();
+    tx_free.pop_back();
+    std::memcpy(umem + addr, data, size);
+
+    uint32_t producer = *tx_ring.producer;
+    auto* descs = static_cast<struct xdp_desc*>(tx_ring.descs);
+    descs[producer & (tx_ring.size - 1)] = {addr, static_cast<uint32_t>(size), 0};
+    __atomic_store_n(tx_ring.producer, producer + 1, __ATOMIC_RELEASE);
+    tx_pending++;
+
+    if (tx_batch_depth == 0) {
+        return (kick_locked() < 0) ? -1 : static_cast<int>(size);
+    }
+    return static_cast<int>(size);
+}
+
+// Method to open a transmit batch
+void XdpEngine::begin_batch() {
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    tx_batch_depth++;
+}
+
+// Method to close a transmit batch, waking the kernel when the outermost one ends
+int XdpEngine::end_batch() {
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    if (tx_batch_depth > 0) {
+        tx_batch_depth--;
+    }
+    return (tx_batch_depth == 0) ? kick_locked() : 0;
+}
+
+// Method to transmit every pending descriptor
+int XdpEngine::flush() {
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    return kick_locked();
+}
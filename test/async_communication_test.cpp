@@ -0,0 +1,183 @@
+#include "../include/async_communicator.hpp"
+#include "../include/message.hpp"
+#include "../include/vehicle.hpp"
+#include "../include/sim_engine.hpp"
+
+#include <sys/resource.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Define os Tipos (cada sensor fornece um tipo a partir deste)
+Ethernet::Type TIPO_BASE_SENSOR = 1000;
+
+// Define os parametros do teste
+int NUM_SENSORES = 1000;       // Componentes assíncronos que fornecem dados.
+int NUM_CONTROLADORES = 1000;  // Componentes assíncronos que pedem dados.
+int NUM_THREADS = 2;           // Threads do executor do veículo.
+int NUM_RESPOSTAS = 10;        // Respostas recebidas por controlador antes de cancelar o interesse.
+int PERIODO = 50;              // Periodo dos interesses (ms).
+int TEMPO_LIMITE = 30;         // Tempo máximo do teste (s).
+
+// Barramento simulado (não requer interface nem privilégios)
+const std::string BARRAMENTO = "async0";
+
+// Controladores que já receberam todas as respostas.
+std::atomic<int> controladores_finalizados{0};
+
+// Tempo de CPU (usuário + sistema) consumido pelo processo, em segundos.
+double tempo_cpu() {
+    rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_utime.tv_sec + uso.ru_stime.tv_sec + (uso.ru_utime.tv_usec + uso.ru_stime.tv_usec) / 1e6;
+}
+
+// Número de threads do processo.
+int threads_do_processo() {
+    std::ifstream status("/proc/self/status");
+    std::string linha;
+    while (std::getline(status, linha)) {
+        if (linha.rfind("Threads:", 0) == 0) {
+            return std::stoi(linha.substr(8));
+        }
+    }
+    return -1;
+}
+
+// Componente Sensor: responde a cada interesse no seu tipo com uma temperatura.
+void iniciar_sensor(AsyncCommunicator& comunicador, const Veiculo::DadosComponente& dados, Ethernet::Type tipo) {
+    // Se inscreve no DataPublisher para receber mensagens de interesse no seu tipo de dado.
+    std::vector<Ethernet::Type> tipos{tipo};
+    dados.data_publisher->subscribe(comunicador.getObserver(), &tipos);
+
+    // Handler serializado: roda uma mensagem por vez, então a mensagem de resposta pode ser reutilizada.
+    auto resposta = std::make_shared<Message>();
+    AsyncCommunicator* self = &comunicador;
+    comunicador.on(tipo, [self, resposta, tipo](const MessageRef& interesse) {
+        // Apenas mensagens de interesse (id componente de destino nao preenchido).
+        if (!pthread_equal(interesse.getDstAddress().component_id, (pthread_t)0)) { return; }
+        int temperatura = 25 + static_cast<int>(tipo % 6);
+        resposta->setType(tipo);
+        resposta->setPeriod(0);
+        resposta->setDstAddress(interesse.getSrcAddress());
+        resposta->setData(&temperatura, sizeof(temperatura));
+        self->send(resposta.get());
+    });
+}
+
+// Componente Controlador: pede periodicamente o tipo de um sensor e cancela após NUM_RESPOSTAS.
+void iniciar_controlador(AsyncCommunicator& comunicador, const Veiculo::DadosComponente& dados, Ethernet::Type tipo) {
+    Ethernet::Mac_Address id_veiculo = dados.id_veiculo;
+    auto respostas = std::make_shared<int>(0);
+    AsyncCommunicator* self = &comunicador;
+
+    // Handler serializado: o contador de respostas não precisa de lock.
+    comunicador.on(tipo, [self, respostas, tipo, id_veiculo](const MessageRef& resposta) {
+        if (++(*respostas) != NUM_RESPOSTAS) { return; }
+        (void)resposta;
+
+        // Cancela o interesse periódico.
+        Ethernet::Type tipo_cancelado = tipo;
+        Message cancelamento;
+        cancelamento.setDstAddress({id_veiculo, (pthread_t)0});
+        cancelamento.setType(Ethernet::TYPE_INTEREST_CANCEL);
+        cancelamento.setPeriod(0);
+        cancelamento.setData(&tipo_cancelado, sizeof(tipo_cancelado));
+        self->send(&cancelamento);
+        controladores_finalizados++;
+    });
+
+    // Envia mensagem de interesse.
+    Message interesse;
+    interesse.setDstAddress({id_veiculo, (pthread_t)0});
+    interesse.setType(tipo);
+    interesse.setPeriod(PERIODO);
+    comunicador.send(&interesse);
+}
+
+int main(int argc, char *argv[]) {
+    auto parse_arg = [&](int index, int default_val) -> int {
+        if (argc > index) {
+            try {
+                return std::stoi(argv[index]);
+            } catch (...) {
+                std::cout << "Aviso: parâmetro " << index << " inválido. Usando valor padrão " << default_val << ".\n";
+            }
+        }
+        return default_val;
+    };
+
+    NUM_SENSORES = std::max(1, parse_arg(1, NUM_SENSORES));
+    NUM_CONTROLADORES = std::max(1, parse_arg(2, NUM_CONTROLADORES));
+    NUM_THREADS = std::max(1, parse_arg(3, NUM_THREADS));
+    PERIODO = std::max(1, parse_arg(4, PERIODO));
+
+    std::cout << "\n"
+              << "============================================================\n"
+              << "⚙️  TESTE: Componentes assíncronos sobre um executor compartilhado\n"
+              << "------------------------------------------------------------\n"
+              << " Uso: " << argv[0] << " [num_sensores] [num_controladores] [threads_executor] [periodo_ms]\n"
+              << " Sensores: " << NUM_SENSORES << "  Controladores: " << NUM_CONTROLADORES
+              << "  Threads do executor: " << NUM_THREADS << "  Período: " << PERIODO << " ms\n"
+              << "============================================================\n"
+              << std::endl;
+
+    double cpu_inicio = tempo_cpu();
+    auto inicio = std::chrono::steady_clock::now();
+    Veiculo veiculo(std::make_unique<NIC<SimEngine>>(BARRAMENTO), "Veiculo", NUM_THREADS);
+    int threads_iniciais = threads_do_processo();
+
+    std::vector<AsyncCommunicator*> componentes;
+    for (int i = 0; i < NUM_SENSORES; ++i) {
+        Ethernet::Type tipo = TIPO_BASE_SENSOR + i;
+        componentes.push_back(veiculo.criar_componente_assincrono("Sensor " + std::to_string(i),
+            [tipo](AsyncCommunicator& comunicador, const Veiculo::DadosComponente& dados) {
+                iniciar_sensor(comunicador, dados, tipo);
+            }));
+    }
+    for (int i = 0; i < NUM_CONTROLADORES; ++i) {
+        Ethernet::Type tipo = TIPO_BASE_SENSOR + (i % NUM_SENSORES);
+        componentes.push_back(veiculo.criar_componente_assincrono("Controlador " + std::to_string(i),
+            [tipo](AsyncCommunicator& comunicador, const Veiculo::DadosComponente& dados) {
+                iniciar_controlador(comunicador, dados, tipo);
+            }));
+    }
+
+    // Espera todos os controladores receberem suas respostas.
+    auto limite = inicio + std::chrono::seconds(TEMPO_LIMITE);
+    while (controladores_finalizados < NUM_CONTROLADORES && std::chrono::steady_clock::now() < limite) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    double duracao = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+    // Mensagens perdidas nas filas limitadas dos componentes e maior ocupação de uma delas.
+    uint64_t descartadas = 0;
+    size_t maior_fila = 0;
+    for (AsyncCommunicator* componente : componentes) {
+        AsyncCommunicator::Statistics estatisticas = componente->statistics();
+        descartadas += estatisticas.messages_dropped + estatisticas.messages_overwritten;
+        maior_fila = std::max(maior_fila, estatisticas.high_water);
+    }
+
+    std::cout << "===============================" << std::endl;
+    std::cout << " Controladores finalizados: " << controladores_finalizados << " / " << NUM_CONTROLADORES << std::endl;
+    std::cout << " Threads do processo: " << threads_do_processo() << " (antes dos componentes: " << threads_iniciais << ")" << std::endl;
+    std::cout << " Descartadas por fila cheia: " << descartadas << "  Maior fila: " << maior_fila << std::endl;
+    std::cout << " Duração (s): " << duracao << std::endl;
+    std::cout << " CPU (s): " << tempo_cpu() - cpu_inicio << std::endl;
+
+    bool sucesso = controladores_finalizados == NUM_CONTROLADORES;
+    std::cout << (sucesso ? "✅ Teste finalizado." : "❌ Tempo limite atingido.") << std::endl;
+    std::cout << "===============================\n" << std::endl;
+
+    // Os serviços do veículo (RSUHandler, TimeSyncManager) não terminam sozinhos: encerra o processo sem destruí-lo.
+    std::cout.flush();
+    _exit(sucesso ? 0 : 1);
+}
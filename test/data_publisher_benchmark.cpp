@@ -0,0 +1,131 @@
+#include "../include/data_publisher.hpp"
+#include "../include/observer.hpp"
+#include "../include/message.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Define os parametros do teste
+int NUM_COMPONENTES = 5000;    // Componentes inscritos no DataPublisher.
+int NUM_TIPOS = 1000;          // Tipos de dados distintos (cada componente fornece um).
+int NUM_INTERESSES = 20000;    // Mensagens de interesse distribuídas.
+
+using Relogio = std::chrono::steady_clock;
+
+// Mensagem de interesse fixa (não volta para nenhum pool).
+struct MensagemFixa : public MessageStorage {
+protected:
+    void recycle() override {}
+};
+
+// Distribuição antiga: percorre todos os inscritos e todos os seus tipos sob o mutex.
+void notificar_varredura(std::unordered_map<Concurrent_Observer*, std::vector<Ethernet::Type>*>& inscritos,
+                         std::mutex& mutex, const MessageRef& mensagem) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& sub : inscritos) {
+        for (auto& tipo : *(sub.second)) {
+            if (tipo == mensagem.getType()) {
+                sub.first->update(mensagem);
+                break;
+            }
+        }
+    }
+}
+
+// Mede a distribuição de interesses para componentes inscritos no DataPublisher.
+int main(int argc, char *argv[]) {
+    auto parse_arg = [&](int index, int default_val) -> int {
+        if (argc > index) {
+            try {
+                return std::stoi(argv[index]);
+            } catch (...) {
+                std::cout << "Aviso: parâmetro " << index << " inválido. Usando valor padrão " << default_val << ".\n";
+            }
+        }
+        return default_val;
+    };
+
+    NUM_COMPONENTES = std::max(1, parse_arg(1, NUM_COMPONENTES));
+    NUM_TIPOS = std::max(1, parse_arg(2, NUM_TIPOS));
+    NUM_INTERESSES = std::max(1, parse_arg(3, NUM_INTERESSES));
+
+    std::cout << "\n"
+              << "============================================================\n"
+              << "🧪  BENCHMARK: Distribuição de interesses no DataPublisher\n"
+              << "------------------------------------------------------------\n"
+              << " Uso: " << argv[0] << " [num_componentes] [num_tipos] [num_interesses]\n"
+              << " Componentes: " << NUM_COMPONENTES << "  Tipos: " << NUM_TIPOS
+              << "  Interesses: " << NUM_INTERESSES << "\n"
+              << "============================================================\n\n";
+
+    // Um interesse (período 0) por tipo.
+    std::vector<MensagemFixa> mensagens(NUM_TIPOS);
+    std::vector<MessageRef> interesses;
+    for (int t = 0; t < NUM_TIPOS; ++t) {
+        mensagens[t].header.type = 1000 + t;
+        mensagens[t].header.period = 0;
+        interesses.emplace_back(&mensagens[t]);
+    }
+
+    // Cada componente fornece o tipo (i % NUM_TIPOS).
+    std::vector<std::unique_ptr<Concurrent_Observer>> observadores;
+    std::vector<std::vector<Ethernet::Type>> tipos(NUM_COMPONENTES);
+    DataPublisher publicador;
+    std::unordered_map<Concurrent_Observer*, std::vector<Ethernet::Type>*> inscritos;
+    std::mutex inscritos_mutex;
+    for (int i = 0; i < NUM_COMPONENTES; ++i) {
+        observadores.push_back(std::make_unique<Concurrent_Observer>());
+        observadores.back()->communicator_address.component_id = static_cast<pthread_t>(i + 1);
+        tipos[i].push_back(1000 + i % NUM_TIPOS);
+        publicador.subscribe(observadores.back().get(), &tipos[i]);
+        inscritos[observadores.back().get()] = &tipos[i];
+    }
+
+    // Mesma sequência de tipos para as duas distribuições.
+    std::mt19937 gerador(42);
+    std::uniform_int_distribution<int> sorteio(0, NUM_TIPOS - 1);
+    std::vector<int> sequencia(NUM_INTERESSES);
+    for (int& t : sequencia) {
+        t = sorteio(gerador);
+    }
+
+    // Esvazia as filas dos observadores entre as medições.
+    auto esvaziar = [&]() {
+        for (auto& obs : observadores) {
+            while (obs->hasMessage()) {
+                obs->updated();
+            }
+        }
+    };
+
+    std::cout << std::left << std::setw(28) << "Distribuição" << std::right
+              << std::setw(16) << "interesses/s" << std::setw(14) << "ns/interesse" << std::endl;
+
+    auto medir = [&](const std::string& nome, auto&& notificar) {
+        auto inicio = Relogio::now();
+        for (int t : sequencia) {
+            notificar(interesses[t]);
+        }
+        double segundos = std::chrono::duration<double>(Relogio::now() - inicio).count();
+        std::cout << std::left << std::setw(28) << nome << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(16) << NUM_INTERESSES / segundos
+                  << std::setw(14) << segundos * 1e9 / NUM_INTERESSES << std::endl;
+        esvaziar();
+    };
+
+    medir("Varredura (todos inscritos)", [&](const MessageRef& m) { notificar_varredura(inscritos, inscritos_mutex, m); });
+    medir("Índice por tipo", [&](const MessageRef& m) { publicador.notify(m); });
+
+    for (auto& obs : observadores) {
+        publicador.unsubscribe(obs.get());
+    }
+
+    std::cout << "\n✅ Benchmark finalizado\n";
+    return 0;
+}
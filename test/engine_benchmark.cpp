@@ -0,0 +1,140 @@
+#include "../include/engine.hpp"
+#include "../include/io_uring_engine.hpp"
+#include "../include/xdp_engine.hpp"
+#include "../include/shm_engine.hpp"
+
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <unistd.h>
+
+// Define os parametros do teste
+int NUM_QUADROS = 100000;    // Numero de quadros enviados por engine.
+int TAMANHO_QUADRO = 256;    // Tamanho de cada quadro (bytes).
+int TAMANHO_LOTE = 32;       // Quadros por lote nos testes com batching.
+
+using Relogio = std::chrono::steady_clock;
+
+// Mede uma engine: o receptor fica em 'interface_rx' e o transmissor em 'interface_tx'.
+template <typename E>
+void medir(const std::string& nome, const std::string& interface_tx, const std::string& interface_rx,
+           const typename E::Config& config, bool em_lote) {
+    std::atomic<int> recebidos{0};
+    std::atomic<long long> ultimo_ns{0};
+    Relogio::time_point inicio;
+
+    E receptor(interface_rx, [&](const void*, size_t) {
+        recebidos++;
+        ultimo_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Relogio::now() - inicio).count();
+    }, true, config);
+    E transmissor(interface_tx, nullptr, false, config);
+
+    // Quadro broadcast com o EtherType do protocolo
+    uint8_t quadro[2048] = {};
+    std::memset(quadro, 0xFF, 6);
+    std::memset(quadro + 6, 0x02, 6);
+    quadro[12] = 0x88;
+    quadro[13] = 0xB5;
+
+    inicio = Relogio::now();
+    for (int i = 0; i < NUM_QUADROS; i += TAMANHO_LOTE) {
+        if (em_lote) {
+            transmissor.begin_batch();
+        }
+        for (int j = i; j < i + TAMANHO_LOTE && j < NUM_QUADROS; ++j) {
+            std::memcpy(quadro + 14, &j, sizeof(j));
+            transmissor.send(quadro, TAMANHO_QUADRO);
+        }
+        if (em_lote) {
+            transmissor.end_batch();
+        }
+    }
+    double envio_s = std::chrono::duration<double>(Relogio::now() - inicio).count();
+
+    // Espera os quadros pendentes (termina após 500 ms sem recebimentos)
+    int anterior = -1;
+    while (recebidos < NUM_QUADROS && recebidos != anterior) {
+        anterior = recebidos;
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+    double recepcao_s = ultimo_ns / 1e9;
+
+    std::cout << std::left << std::setw(24) << nome << std::right << std::fixed << std::setprecision(0)
+              << std::setw(14) << NUM_QUADROS / envio_s
+              << std::setw(14) << (recepcao_s > 0 ? recebidos / recepcao_s : 0)
+              << std::setw(12) << recebidos << "/" << NUM_QUADROS << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    // Sem o par veth só a ShmEngine (que não precisa de privilégios) é medida
+    bool usar_veth = argc >= 3;
+    if (argc == 2) {
+        std::cout << "Erro: Por favor, informe as duas pontas do par veth.\n";
+        std::cout << "Uso: " << argv[0] << " [<interface-tx> <interface-rx> [num_quadros] [tamanho_quadro] [tamanho_lote] [xdp]]\n";
+        std::cout << "Exemplo: ip link add vtest0 type veth peer name vtest1 && ip link set vtest0 up && ip link set vtest1 up\n";
+        return 1;
+    }
+
+    std::string interface_tx = usar_veth ? argv[1] : "";
+    std::string interface_rx = usar_veth ? argv[2] : "";
+
+    auto parse_arg = [&](int index, int default_val) -> int {
+        if (argc > index) {
+            try {
+                return std::stoi(argv[index]);
+            } catch (...) {
+                std::cout << "Aviso: parâmetro " << index << " inválido. Usando valor padrão " << default_val << ".\n";
+            }
+        }
+        return default_val;
+    };
+
+    NUM_QUADROS = parse_arg(3, NUM_QUADROS);
+    TAMANHO_QUADRO = std::max(64, std::min(1514, parse_arg(4, TAMANHO_QUADRO)));
+    TAMANHO_LOTE = std::max(1, parse_arg(5, TAMANHO_LOTE));
+    bool usar_xdp = parse_arg(6, 0) != 0;
+
+    std::cout << "\n"
+              << "============================================================\n"
+              << "🧪  BENCHMARK: Engines de transmissão/recepção"
+              << (usar_veth ? " em " + interface_tx + " -> " + interface_rx : " (memória compartilhada)") << "\n"
+              << "------------------------------------------------------------\n"
+              << " Quadros: " << NUM_QUADROS << "  Tamanho: " << TAMANHO_QUADRO << " bytes  Lote: " << TAMANHO_LOTE << "\n"
+              << "============================================================\n\n";
+
+    std::cout << std::left << std::setw(24) << "Engine" << std::right
+              << std::setw(14) << "TX quadros/s" << std::setw(14) << "RX quadros/s"
+              << std::setw(18) << "Recebidos" << std::endl;
+
+    if (usar_veth) {
+        Engine::Config socket_config;
+        socket_config.receive_mode = Engine::ReceiveMode::SOCKET;
+        Engine::Config ring_config;
+        IoUringEngine::Config uring_config;
+
+        medir<Engine>("Engine (socket)", interface_tx, interface_rx, socket_config, false);
+        medir<Engine>("Engine (ring)", interface_tx, interface_rx, ring_config, false);
+        medir<Engine>("Engine (ring, lote)", interface_tx, interface_rx, ring_config, true);
+        medir<IoUringEngine>("IoUringEngine", interface_tx, interface_rx, uring_config, false);
+        medir<IoUringEngine>("IoUringEngine (lote)", interface_tx, interface_rx, uring_config, true);
+
+        // O XDP substitui o programa da interface de recepção, por isso só roda quando pedido
+        if (usar_xdp) {
+            XdpEngine::Config xdp_config;
+            medir<XdpEngine>("XdpEngine (lote)", interface_tx, interface_rx, xdp_config, true);
+        }
+    }
+
+    // Transmissor e receptor compartilham o anel; quadros sobrescritos antes da leitura aparecem como perdidos
+    std::string anel = "engine_benchmark_" + std::to_string(getpid());
+    ShmEngine::Config shm_config;
+    medir<ShmEngine>("ShmEngine", anel, anel, shm_config, false);
+    ShmEngine::unlink(anel);
+
+    std::cout << "\n✅ Benchmark finalizado\n";
+    return 0;
+}
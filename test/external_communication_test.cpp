@@ -99,25 +99,23 @@ void* rotina_sensor_gps(void* arg) {
     int num_respostas_enviadas = 0;
 
     while (num_respostas_enviadas < NUM_RESPOSTAS) {
-        // Verifica se recebeu mensagem.
-        if (comunicador.hasMessage()) {
-            Message mensagem;
-            comunicador.receive(&mensagem);
-            
-            // Verifica se a mensagem eh de interesse (nao preencheu id componente no endereco de destino).
-            if (pthread_equal(mensagem.getDstAddress().component_id, (pthread_t)0)) {
-                // Responde a mensagem.
-                mensagem.setDstAddress(mensagem.getSrcAddress());
-                mensagem.setData(reinterpret_cast<DadosSensorGPS*>(&posicao), sizeof(DadosSensorGPS));
-                comunicador.send(&mensagem);
-                //std::cout << "📬 " << dados->nome << ": Enviou posicao." << std::endl;
-                
-                num_respostas_enviadas++;
-                // Incrementa posicao.
-                posicao.x++;
-                posicao.y++;
+        // Espera receber mensagem.
+        Message mensagem;
+        comunicador.receive(&mensagem);
+        
+        // Verifica se a mensagem eh de interesse (nao preencheu id componente no endereco de destino).
+        if (pthread_equal(mensagem.getDstAddress().component_id, (pthread_t)0)) {
+            // Responde a mensagem.
+            mensagem.setDstAddress(mensagem.getSrcAddress());
+            mensagem.setData(reinterpret_cast<DadosSensorGPS*>(&posicao), sizeof(DadosSensorGPS));
+            comunicador.send(&mensagem);
+            //std::cout << "📬 " << dados->nome << ": Enviou posicao." << std::endl;
             
-            }
+            num_respostas_enviadas++;
+            // Incrementa posicao.
+            posicao.x++;
+            posicao.y++;
+        
         }
     }
 
@@ -0,0 +1,139 @@
+#include "../include/rsu.hpp"
+#include "../include/vehicle.hpp"
+#include "../include/sim_engine.hpp"
+
+#include <sys/resource.h>
+#include <atomic>
+#include <unistd.h>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Parametros de teste.
+int NUM_VEICULOS = 20;      // Número de veículos simulados no processo.
+int DURACAO = 10;           // Duração da simulação (s).
+int LATENCIA = 100;         // Latência do meio (us).
+int JITTER = 50;            // Jitter do meio (us).
+double PERDA = 0.0;         // Probabilidade de perda de cada quadro por receptor.
+int BANDA = 0;              // Largura de banda do meio (Mbit/s, 0 = ilimitada).
+
+// Barramento simulado compartilhado por todas as NICs.
+const std::string BARRAMENTO = "sim0";
+
+// Posições dos veículos: cada componente GPS criado usa a próxima posição.
+std::vector<Ethernet::Position> posicoes;
+std::atomic<int> proximo_gps{0};
+
+// GPS: responde aos interesses de posição com a posição fixa do veículo.
+void* rotina_gps(void* arg) {
+    Veiculo::DadosComponente* dados = (Veiculo::DadosComponente*)arg;
+    Communicator comunicador(dados->protocolo, dados->id_veiculo, pthread_self());
+    Ethernet::Position posicao = posicoes[proximo_gps++];
+
+    std::vector<Ethernet::Type> tipos;
+    tipos.push_back(Ethernet::TYPE_POSITION_DATA);
+    dados->data_publisher->subscribe(comunicador.getObserver(), &tipos);
+
+    while (true) {
+        Message mensagem;
+        comunicador.receive(&mensagem);
+        // Verifica se a mensagem é de interesse (não preencheu id componente no endereço de destino).
+        if (pthread_equal(mensagem.getDstAddress().component_id, (pthread_t)0)) {
+            mensagem.setDstAddress(mensagem.getSrcAddress());
+            mensagem.setData(reinterpret_cast<Ethernet::Position*>(&posicao), sizeof(Ethernet::Position));
+            comunicador.send(&mensagem);
+        }
+    }
+    return nullptr;
+}
+
+// Tempo de CPU (user + sys) consumido pelo processo, em segundos.
+double tempo_cpu() {
+    struct rusage uso {};
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_utime.tv_sec + uso.ru_utime.tv_usec / 1e6 + uso.ru_stime.tv_sec + uso.ru_stime.tv_usec / 1e6;
+}
+
+// Simulação de uma frota em um único processo, sobre o barramento da SimEngine (sem sudo).
+int main(int argc, char *argv[]) {
+    auto parse_arg = [&](int index, int default_val) -> int {
+        if (argc > index) {
+            try {
+                return std::stoi(argv[index]);
+            } catch (...) {
+                std::cout << "Aviso: parâmetro " << index << " inválido. Usando valor padrão " << default_val << ".\n";
+            }
+        }
+        return default_val;
+    };
+
+    NUM_VEICULOS = parse_arg(1, NUM_VEICULOS);
+    DURACAO = parse_arg(2, DURACAO);
+    LATENCIA = parse_arg(3, LATENCIA);
+    JITTER = parse_arg(4, JITTER);
+    PERDA = parse_arg(5, 0) / 100.0;
+    BANDA = parse_arg(6, BANDA);
+
+    std::cout << "\n"
+              << "============================================================\n"
+              << "🚗  TESTE: Simulação de frota em um processo (SimEngine)\n"
+              << "------------------------------------------------------------\n"
+              << " Uso: " << argv[0] << " [num_veiculos] [duracao_s] [latencia_us] [jitter_us] [perda_%] [banda_mbps]\n"
+              << " Veículos: " << NUM_VEICULOS << "  Duração: " << DURACAO << " s  Latência: " << LATENCIA
+              << " us  Jitter: " << JITTER << " us  Perda: " << PERDA * 100 << " %  Banda: " << BANDA << " Mbit/s\n"
+              << "============================================================\n"
+              << std::endl;
+
+    // Configura o meio antes de criar as NICs.
+    SimEngine::Config meio;
+    meio.latency_us = LATENCIA;
+    meio.jitter_us = JITTER;
+    meio.loss = PERDA;
+    meio.bandwidth_bps = static_cast<uint64_t>(BANDA) * 1000000ULL;
+    SimEngine::set_medium(BARRAMENTO, meio);
+
+    double cpu_inicio = tempo_cpu();
+
+    std::cout << "Criando RSU para cada quadrante:" << std::endl;
+    std::vector<std::unique_ptr<RSU>> rsus;
+    rsus.push_back(std::make_unique<RSU>(std::make_unique<NIC<SimEngine>>(BARRAMENTO), 1, Ethernet::Quadrant{0, 100, 0, 100}));
+    rsus.push_back(std::make_unique<RSU>(std::make_unique<NIC<SimEngine>>(BARRAMENTO), 2, Ethernet::Quadrant{-100, 0, 0, 100}));
+    rsus.push_back(std::make_unique<RSU>(std::make_unique<NIC<SimEngine>>(BARRAMENTO), 3, Ethernet::Quadrant{-100, 0, -100, 0}));
+    rsus.push_back(std::make_unique<RSU>(std::make_unique<NIC<SimEngine>>(BARRAMENTO), 4, Ethernet::Quadrant{0, 100, -100, 0}));
+
+    // Sorteia as posições dos veículos no plano dos quatro quadrantes.
+    std::mt19937 gerador(42);
+    std::uniform_int_distribution<int> coordenada(-95, 95);
+    for (int i = 0; i < NUM_VEICULOS; ++i) {
+        posicoes.push_back({coordenada(gerador), coordenada(gerador)});
+    }
+
+    std::cout << "\nCriando " << NUM_VEICULOS << " veículos." << std::endl;
+    std::vector<std::unique_ptr<Veiculo>> veiculos;
+    for (int i = 0; i < NUM_VEICULOS; ++i) {
+        veiculos.push_back(std::make_unique<Veiculo>(std::make_unique<NIC<SimEngine>>(BARRAMENTO), "Veiculo " + std::to_string(i)));
+        veiculos.back()->criar_componente("GPS", rotina_gps);
+    }
+    double cpu_criacao = tempo_cpu() - cpu_inicio;
+
+    sleep(DURACAO);
+
+    double cpu_total = tempo_cpu() - cpu_inicio;
+    SimEngine::Statistics estatisticas = SimEngine::statistics(BARRAMENTO);
+
+    std::cout << "\n===============================" << std::endl;
+    std::cout << " Quadros enviados: " << estatisticas.frames_sent << std::endl;
+    std::cout << " Cópias entregues: " << estatisticas.frames_delivered << std::endl;
+    std::cout << " Cópias perdidas: " << estatisticas.frames_lost << std::endl;
+    std::cout << " Cópias filtradas: " << estatisticas.frames_filtered << std::endl;
+    std::cout << " CPU criação (s): " << cpu_criacao << std::endl;
+    std::cout << " CPU total (s): " << cpu_total << std::endl;
+    std::cout << " CPU por veículo (ms/s): " << (cpu_total - cpu_criacao) * 1000.0 / NUM_VEICULOS / DURACAO << std::endl;
+    std::cout << "✅ Teste finalizado." << std::endl;
+    std::cout << "===============================\n" << std::endl;
+
+    // Os componentes não terminam sozinhos: encerra o processo sem destruir veículos e RSUs.
+    std::cout.flush();
+    _exit(0);
+}
@@ -149,19 +149,18 @@ void* rotina_gps_estatico(void* arg) {
     int num_respostas_enviadas = 0;
 
     while (true) {
-        if (comunicador.hasMessage()) {
-            Message mensagem;
-            comunicador.receive(&mensagem);
+        // Bloqueia até receber uma mensagem.
+        Message mensagem;
+        comunicador.receive(&mensagem);
 
-            // Verifica se a mensagem é de interesse (não preencheu id componente no endereço de destino).
-            if (pthread_equal(mensagem.getDstAddress().component_id, (pthread_t)0)) {
-                // Responde a mensagem.
-                mensagem.setDstAddress(mensagem.getSrcAddress());
-                mensagem.setData(reinterpret_cast<Ethernet::Position*>(&posicao), sizeof(Ethernet::Position));
-                comunicador.send(&mensagem);
-                //std::cout << "📬 " << dados->nome << ": Enviou posição." << std::endl;
-                num_respostas_enviadas++;
-            }
+        // Verifica se a mensagem é de interesse (não preencheu id componente no endereço de destino).
+        if (pthread_equal(mensagem.getDstAddress().component_id, (pthread_t)0)) {
+            // Responde a mensagem.
+            mensagem.setDstAddress(mensagem.getSrcAddress());
+            mensagem.setData(reinterpret_cast<Ethernet::Position*>(&posicao), sizeof(Ethernet::Position));
+            comunicador.send(&mensagem);
+            //std::cout << "📬 " << dados->nome << ": Enviou posição." << std::endl;
+            num_respostas_enviadas++;
         }
     }
     // Remove o observador do DataPublisher.
@@ -42,28 +42,41 @@ void* rotina_controlador(void* arg) {
     // Contador de respostas recebidas.
     int respostas_recebidas = 0;
 
+    MessageRef respostas[16];
     while (respostas_recebidas < NUM_SENSORES * NUM_RESPOSTAS) {
-        // Espera recebimento de mensagens.
-        comunicador.receive(&mensagem);
-
-        // Extrai o endereço de destino da mensagem recebida.
-        Ethernet::Address endereco_destino = mensagem.getDstAddress();
-
-        // Verifica se a mensagem recebida eh uma resposta (component_id foi preenchido).
-        if (!pthread_equal(endereco_destino.component_id, (pthread_t)0)) {
-            // Extrai o tipo da mensagem recebida.
-            Ethernet::Type tipo = mensagem.getType();
-            // Verifica se a resposta eh do sensor temperatura.
-            if (tipo == TIPO_SENSOR_TEMPERATURA) {
-                // Incrementa contador de respostas recebidas.
-                respostas_recebidas++;
-                // Extrai dados da mensagem recebida.
-                int dado = *(int*)mensagem.data();
-                std::cout << "📬 " << dados->nome << ": recebeu temperatura: " << dado << std::endl;
+        // Espera respostas e retira em lote as já recebidas (apenas leitura: os dados não são copiados).
+        size_t recebidas = comunicador.receive_many(respostas, 16, std::chrono::seconds(1));
+        for (size_t i = 0; i < recebidas; i++) {
+            MessageRef resposta = std::move(respostas[i]);
+
+            // Extrai o endereço de destino da mensagem recebida.
+            Ethernet::Address endereco_destino = resposta.getDstAddress();
+
+            // Verifica se a mensagem recebida eh uma resposta (component_id foi preenchido).
+            if (!pthread_equal(endereco_destino.component_id, (pthread_t)0)) {
+                // Extrai o tipo da mensagem recebida.
+                Ethernet::Type tipo = resposta.getType();
+                // Verifica se a resposta eh do sensor temperatura.
+                if (tipo == TIPO_SENSOR_TEMPERATURA) {
+                    // Incrementa contador de respostas recebidas.
+                    respostas_recebidas++;
+                    // Extrai dados da mensagem recebida.
+                    int dado = *(const int*)resposta.data();
+                    std::cout << "📬 " << dados->nome << ": recebeu temperatura: " << dado << std::endl;
+                }
             }
         }
     }
 
+    // Cancela o interesse periódico: os sensores deixam de receber os pedidos deste controlador.
+    Ethernet::Type tipo_cancelado = TIPO_SENSOR_TEMPERATURA;
+    Message cancelamento;
+    cancelamento.setDstAddress({dados->id_veiculo, (pthread_t)0});
+    cancelamento.setType(Ethernet::TYPE_INTEREST_CANCEL);
+    cancelamento.setPeriod(0);
+    cancelamento.setData(&tipo_cancelado, sizeof(tipo_cancelado));
+    comunicador.send(&cancelamento);
+
     // Informa que terminou de receber todas as respostas.
     std::cout << "📬 " << dados->nome << ": recebeu TODAS SUAS RESPOSTAS." << std::endl;
 
@@ -94,44 +107,49 @@ void* rotina_sensor_temperatura(void* arg) {
         // Simula a produção de dados.
         temperatura = 25 + (std::rand() % 6); // Gera número entre 25 e 30
 
-        if (comunicador.hasMessage()) {
-            // Carrega mensagem recebida.
-            comunicador.receive(&mensagem);
-            // Verifica se a mensagem recebida eh de interesse (id componente nao foi preenchido).
-            if (pthread_equal(mensagem.getDstAddress().component_id, (pthread_t)0)) {
-                Ethernet::Address destino = mensagem.getSrcAddress();
+        // Espera mensagem (o prazo apenas reavalia a condição de término).
+        if (!comunicador.receive_for(&mensagem, std::chrono::milliseconds(100))) { continue; }
+        // Verifica se a mensagem recebida eh de interesse (id componente nao foi preenchido).
+        if (pthread_equal(mensagem.getDstAddress().component_id, (pthread_t)0)) {
+            Ethernet::Address destino = mensagem.getSrcAddress();
 
-                // Ignora interesse caso ja tenha enviado o limite de resposta para destino (apenas para finalizar teste).
-                if (requisicoes[destino.component_id] == NUM_RESPOSTAS) { continue; }
+            // Ignora interesse caso ja tenha enviado o limite de resposta para destino (apenas para finalizar teste).
+            if (requisicoes[destino.component_id] == NUM_RESPOSTAS) { continue; }
 
-                std::cout << "📬 " << dados->nome << ": recebeu interesse." << std::endl;
+            std::cout << "📬 " << dados->nome << ": recebeu interesse." << std::endl;
 
-                if (requisicoes.find(destino.component_id) == requisicoes.end()) {
-                    requisicoes[destino.component_id] = 0;
-                } 
+            if (requisicoes.find(destino.component_id) == requisicoes.end()) {
+                requisicoes[destino.component_id] = 0;
+            } 
 
-                // Prepara mensagem de resposta.
-                mensagem.setType(TIPO_SENSOR_TEMPERATURA);
-                mensagem.setDstAddress(destino);
-                mensagem.setData(reinterpret_cast<char*>(&temperatura), sizeof(int));
-                // Envia mensagem de resposta.
-                comunicador.send(&mensagem);
+            // Prepara mensagem de resposta.
+            mensagem.setType(TIPO_SENSOR_TEMPERATURA);
+            mensagem.setDstAddress(destino);
+            mensagem.setData(reinterpret_cast<char*>(&temperatura), sizeof(int));
+            // Envia mensagem de resposta.
+            comunicador.send(&mensagem);
 
-                // Incrementa numero de respostas enviadas para interessado.
-                requisicoes[destino.component_id]++;
+            // Incrementa numero de respostas enviadas para interessado.
+            requisicoes[destino.component_id]++;
 
-                // Verifica se interessado ja recebeu numero max de respostas.
-                if (requisicoes[destino.component_id] == NUM_RESPOSTAS) {
-                    num_requisicoes_finalizadas++;
-                }
+            // Verifica se interessado ja recebeu numero max de respostas.
+            if (requisicoes[destino.component_id] == NUM_RESPOSTAS) {
+                num_requisicoes_finalizadas++;
+            }
 
-                if (num_requisicoes_finalizadas == NUM_CONTROLADORES) {
-                        break;
-                }
+            if (num_requisicoes_finalizadas == NUM_CONTROLADORES) {
+                    break;
             }
         }
     }
     
+    // Resume os fluxos periódicos do DataPublisher (disparos, perdas de prazo e jitter, inclusive dos já cancelados).
+    DataPublisher::Statistics contadores = dados->data_publisher->statistics();
+    std::cout << "⏱️ " << dados->nome << ": " << contadores.live_streams << " fluxos periódicos ativos ("
+              << contadores.live_interests << " interesses), " << contadores.streams_created << " criados, "
+              << contadores.releases << " disparos, " << contadores.deadline_misses << " prazos perdidos, jitter máx "
+              << contadores.max_jitter.count() << " us." << std::endl;
+
     // Remove do Agendador o periodo de resposta para esse interessado.
     dados->data_publisher->unsubscribe(comunicador.getObserver());
 